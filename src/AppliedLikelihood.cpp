@@ -25,7 +25,7 @@ std::vector<std::unique_ptr<AppliedLikelihood>> AppliedLikelihoodFamily(
     std::size_t nt
 ) {
     std::vector<std::unique_ptr<AppliedLikelihood>> family;
-    family.reserve(eastings.size());
+    family.reserve(nt);
     
     auto t_it = t.begin();
     auto eastings_it = eastings.begin();
@@ -35,7 +35,7 @@ std::vector<std::unique_ptr<AppliedLikelihood>> AppliedLikelihoodFamily(
     auto orientations_it = orientations.begin();
 
     for(std::size_t ind = 0; ind < nt; ++ind) {
-        if(ind == *t_it) {
+        if(t_it != t.end() && ind == *t_it) {
             ++t_it;
             family.emplace_back(
                 new AppliedLocationLikelihood(
@@ -60,7 +60,7 @@ std::vector<std::unique_ptr<AppliedLikelihood>> AppliedLikelihoodFamilyFromGPS(
     std::size_t nt
 ) {
     std::vector<std::unique_ptr<AppliedLikelihood>> family;
-    family.reserve(eastings.size());
+    family.reserve(nt);
     
     auto t_it = t.begin();
     auto eastings_it = eastings.begin();
@@ -68,7 +68,7 @@ std::vector<std::unique_ptr<AppliedLikelihood>> AppliedLikelihoodFamilyFromGPS(
     auto hdops_it = hdops.begin();
 
     for(std::size_t ind = 0; ind < nt; ++ind) {
-        if(ind == *t_it) {
+        if(t_it != t.end() && ind == *t_it) {
             ++t_it;
             family.emplace_back(
                 new AppliedLocationLikelihood(
@@ -85,6 +85,43 @@ std::vector<std::unique_ptr<AppliedLikelihood>> AppliedLikelihoodFamilyFromGPS(
     return family;
 }
 
+/**
+ * Create a family of GPS observation distributions whose errors are truncated 
+ * to the nsigma-contour of each observation's error distribution
+*/
+std::vector<std::unique_ptr<AppliedLikelihood>> 
+AppliedTruncatedLikelihoodFamilyFromGPS(
+    std::vector<double> eastings, std::vector<double> northings, 
+    std::vector<double> hdops, double uere, std::vector<std::size_t> t,
+    std::size_t nt, double nsigma
+) {
+    std::vector<std::unique_ptr<AppliedLikelihood>> family;
+    family.reserve(nt);
+    
+    auto t_it = t.begin();
+    auto eastings_it = eastings.begin();
+    auto northings_it = northings.begin();
+    auto hdops_it = hdops.begin();
+
+    for(std::size_t ind = 0; ind < nt; ++ind) {
+        if(t_it != t.end() && ind == *t_it) {
+            ++t_it;
+            family.emplace_back(
+                new AppliedTruncatedLocationLikelihood(
+                    AppliedTruncatedLocationLikelihood::from_hdop_uere(
+                        *(eastings_it++), *(northings_it++), *(hdops_it++), 
+                        uere, nsigma
+                    )
+                )
+            );
+        } else {
+            family.emplace_back(new AppliedFlatLikelihood());
+        }
+    }
+
+    return family;
+}
+
 /**
  * Demonstrate that we can create and call likelihoods of mixed types
 */
@@ -105,3 +142,29 @@ double Test__AppliedLikelihoodFamily(
     
     return f[0]->dstate(**states->begin()) + f[1]->dstate(**states->begin());
 }
+
+/**
+ * Evaluate a GPS likelihood family at a single state, returning the 
+ * log-likelihood contribution for each timepoint
+*/
+// [[Rcpp::export]]
+std::vector<double> Test__AppliedLikelihoodFamilyFromGPS(
+    std::vector<double> eastings, std::vector<double> northings, 
+    std::vector<double> hdops, double uere, std::vector<std::size_t> t,
+    std::size_t nt,
+    Rcpp::XPtr<
+        std::vector<RookDirectionalStatespace::StateType*>
+    > states
+) {
+
+    std::vector<std::unique_ptr<AppliedLikelihood>> f = 
+        AppliedLikelihoodFamilyFromGPS(eastings, northings, hdops, uere, t, nt);
+
+    std::vector<double> res;
+    res.reserve(f.size());
+    for(auto & lik : f) {
+        res.push_back(lik->dstate(**states->begin()));
+    }
+
+    return res;
+}
@@ -39,17 +39,32 @@ struct AppliedLikelihood {
         particle_transition_probability
     > ParticleType;
 
-    virtual double dparticle(const ParticleType & particle) = 0;
+    virtual ~AppliedLikelihood() { }
+
+    /**
+     * Likelihood contributions only depend on a particle's state, so particles
+     * of any type (i.e., with different random number sources) can be used
+    */
+    template<typename Particle>
+    double dparticle(const Particle & particle) {
+        return dstate(*particle.state);
+    }
 
     virtual double dstate(const StateType & state) = 0;
 
+    /**
+     * Upper bound for dstate over all states, i.e., to bound the remaining 
+     * contributions to a marginal log-likelihood
+    */
+    virtual double log_max_density() const = 0;
+
 };
 
 struct AppliedFlatLikelihood : public AppliedLikelihood {
-    double dparticle(const ParticleType & particle) {
+    double dstate(const StateType & state) {
         return 0;
     }
-    double dstate(const StateType & state) {
+    double log_max_density() const {
         return 0;
     }
 };
@@ -86,12 +101,58 @@ struct AppliedLocationLikelihood : public AppliedLikelihood {
             return AppliedLocationLikelihood(lik);
         }
 
-        double dparticle(const ParticleType & particle) {
-            return likelihood_impl.dparticle(particle);
+        double dstate(const StateType & state) {
+            return likelihood_impl.dstate(state);
+        }
+
+        double log_max_density() const {
+            return likelihood_impl.log_max_density();
+        }
+
+};
+
+/**
+ * Location likelihood for observation errors that are truncated to the 
+ * nsigma-contour of the error distribution, i.e., to pair with proposals that 
+ * discard particles outside of the contour.  The truncated density is 
+ * renormalized by the probability mass the error distribution assigns to the 
+ * contour, which is 1 - exp(-nsigma^2 / 2) for bivariate normal errors.
+*/
+struct AppliedTruncatedLocationLikelihood : public AppliedLikelihood {
+
+    private:
+
+        ProjectedLocationLikelihood likelihood_impl;
+        double nsigma;
+        double log_contour_mass;
+
+        AppliedTruncatedLocationLikelihood(
+            ProjectedLocationLikelihood & likelihood, double n
+        ) : likelihood_impl(likelihood), nsigma(n), 
+            log_contour_mass(std::log1p(-std::exp(- n * n / 2))) { }
+
+    public:
+
+        static AppliedTruncatedLocationLikelihood from_hdop_uere(
+            double easting, double northing, double hdop, double uere,
+            double nsigma
+        ) {
+            ProjectedLocationLikelihood lik = 
+                ProjectedLocationLikelihood::from_hdop_uere(   
+                    easting, northing, hdop, uere
+                );
+            return AppliedTruncatedLocationLikelihood(lik, nsigma);
         }
 
         double dstate(const StateType & state) {
-            return likelihood_impl.dstate(state);
+            if(!likelihood_impl.within(state, nsigma)) {
+                return R_NegInf;
+            }
+            return likelihood_impl.dstate(state) - log_contour_mass;
+        }
+
+        double log_max_density() const {
+            return likelihood_impl.log_max_density() - log_contour_mass;
         }
 
 };
@@ -109,4 +170,11 @@ std::vector<std::unique_ptr<AppliedLikelihood>> AppliedLikelihoodFamilyFromGPS(
     std::size_t nt
 );
 
+std::vector<std::unique_ptr<AppliedLikelihood>> 
+AppliedTruncatedLikelihoodFamilyFromGPS(
+    std::vector<double> eastings, std::vector<double> northings, 
+    std::vector<double> hdops, double uere, std::vector<std::size_t> t,
+    std::size_t nt, double nsigma
+);
+
 #endif
\ No newline at end of file
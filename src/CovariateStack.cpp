@@ -0,0 +1,115 @@
+#include "CovariateStack.h"
+
+CovariateStack::CovariateStack(
+    const RookDirectionalStatespace & statespace,
+    const std::vector<Eigen::MatrixXd> & layer_covariates,
+    const std::vector<std::size_t> & schedule, std::size_t period_length
+) : period_layers(schedule), steps_per_period(period_length),
+    rates(layer_covariates.size()), rate_beta(layer_covariates.size()),
+    rate_delta(layer_covariates.size(), 0),
+    rate_evaluated(layer_covariates.size(), false) {
+
+    if(layer_covariates.empty()) {
+        Rcpp::stop("Covariate stack must have at least one layer");
+    }
+    if(period_layers.empty()) {
+        Rcpp::stop("Schedule must have at least one period");
+    }
+    if(steps_per_period == 0) {
+        Rcpp::stop("Periods must have at least one time step");
+    }
+    for(auto l : period_layers) {
+        if(l >= layer_covariates.size()) {
+            Rcpp::stop("Schedule refers to a layer that does not exist");
+        }
+    }
+
+    std::size_t p = statespace.grid.empty() ?
+        0 : statespace.grid.begin()->second.x.size();
+    std::size_t ncells = statespace.neastings * statespace.nnorthings;
+
+    // extract the covariates for the statespace's locations
+    layers.reserve(layer_covariates.size());
+    for(auto & covariates : layer_covariates) {
+        if(static_cast<std::size_t>(covariates.rows()) != p ||
+           static_cast<std::size_t>(covariates.cols()) != ncells) {
+            Rcpp::stop(
+                "Covariate layers must have the same dimensions as the "
+                "statespace's covariates"
+            );
+        }
+        layers.emplace_back(statespace.location_columns(covariates));
+    }
+}
+
+const Eigen::VectorXd & CovariateStack::transition_rates(
+    std::size_t layer, const Eigen::VectorXd & beta, double delta
+) {
+    if(!rate_evaluated[layer] || rate_delta[layer] != delta ||
+       rate_beta[layer].size() != beta.size() || rate_beta[layer] != beta) {
+        // Hewitt et. al. (2023) eq. 14 for all locations at once
+        rates[layer].noalias() = layers[layer].transpose() * beta;
+        rates[layer] = delta * rates[layer].array().exp();
+        rate_beta[layer] = beta;
+        rate_delta[layer] = delta;
+        rate_evaluated[layer] = true;
+    }
+    return rates[layer];
+}
+
+/**
+ * Build a stack of time-varying covariates for a statespace, i.e., for
+ * movement models with diurnal or seasonal effects
+ *
+ * @param statespace Object constructed from \code{build_statespace}
+ * @param layers list of covariate matrices with the same layout as the
+ *   covariates used to build the statespace
+ * @param schedule 0-based index of the layer to use during each period,
+ *   which repeats cyclically, e.g., 24 entries for hourly periods over a day
+ * @param period_length number of discrete time steps in each period
+*/
+// [[Rcpp::export]]
+Rcpp::XPtr<CovariateStack> build_covariate_stack(
+    Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::List layers,
+    std::vector<std::size_t> schedule, std::size_t period_length = 1
+) {
+    std::vector<Eigen::MatrixXd> layer_covariates;
+    layer_covariates.reserve(layers.size());
+    for(std::size_t l = 0; l < static_cast<std::size_t>(layers.size()); ++l) {
+        Rcpp::NumericMatrix covariates = layers[l];
+        layer_covariates.emplace_back(Eigen::Map<Eigen::MatrixXd>(
+            covariates.begin(), covariates.nrow(), covariates.ncol()
+        ));
+    }
+    return Rcpp::XPtr<CovariateStack>(
+        new CovariateStack(
+            *statespace, layer_covariates, schedule, period_length
+        ),
+        true
+    );
+}
+
+/**
+ * Uniformized transition rates for each location at a time step
+ *
+ * @param stack Object constructed from \code{build_covariate_stack}
+ * @param t 0-based time step
+ * @return list with the 0-based layer active at the time step, and the rates
+ *   for each location, in the order of \code{statespace_columns}
+*/
+// [[Rcpp::export]]
+Rcpp::List covariate_stack_rates(
+    Rcpp::XPtr<CovariateStack> stack, Eigen::VectorXd beta, double delta,
+    std::size_t t
+) {
+    if(static_cast<std::size_t>(beta.size()) != stack->ncovariates()) {
+        Rcpp::stop("Argument beta has the wrong length");
+    }
+    std::size_t layer = stack->layer(t);
+    const Eigen::VectorXd & rates = stack->transition_rates(layer, beta, delta);
+    return Rcpp::List::create(
+        Rcpp::Named("layer") = layer,
+        Rcpp::Named("rates") = Rcpp::NumericVector(rates.data(),
+            rates.data() + rates.size())
+    );
+}
@@ -0,0 +1,190 @@
+/**
+ * Time-varying location-based covariates, i.e., for diurnal or seasonal
+ * effects on movement
+*/
+
+#ifndef MOVECON_COVARIATE_STACK_H
+#define MOVECON_COVARIATE_STACK_H
+
+// [[Rcpp::depends(RcppEigen)]]
+
+#include <RcppEigen.h>
+
+#include "Domain.h"
+
+#include <vector>
+
+/**
+ * Stack of covariate layers for a statespace's locations, with a cyclic
+ * schedule that activates one layer during each period of time.  Periods span
+ * a fixed number of discrete time steps, and several periods may share a
+ * layer, e.g., 24 hourly periods that share day and night layers.
+ *
+ * The stack also caches the transition rates implied by each layer.  Rate
+ * tables are evaluated the first time a layer is used with a set of model
+ * parameters, and are reused until the layer is used with other parameters,
+ * so periods that share a layer share a table, and tables persist between
+ * particle filter runs that only change other model parameters.  Evaluating
+ * rate tables writes to the stack, so a stack must not be used from several
+ * threads at once.
+*/
+class CovariateStack {
+
+    private:
+
+        // layers[l] has one column of covariates for each location, in order
+        // of Location::index
+        std::vector<Eigen::MatrixXd> layers;
+
+        // layer used during each period of the schedule
+        std::vector<std::size_t> period_layers;
+        std::size_t steps_per_period;
+
+        // rates[l] holds the rates for layers[l] if rate_evaluated[l] is true
+        // and the layer was evaluated with rate_beta[l] and rate_delta[l]
+        std::vector<Eigen::VectorXd> rates;
+        std::vector<Eigen::VectorXd> rate_beta;
+        std::vector<double> rate_delta;
+        std::vector<bool> rate_evaluated;
+
+    public:
+
+        /**
+         * @param statespace statespace the covariates describe
+         * @param layer_covariates covariate matrices with the same layout as
+         *   the covariates used to build the statespace, i.e., one column for
+         *   each grid cell, including cells excluded from the statespace
+         * @param schedule 0-based index of the layer to use during each
+         *   period, which repeats cyclically
+         * @param period_length number of time steps in each period
+        */
+        CovariateStack(
+            const RookDirectionalStatespace & statespace,
+            const std::vector<Eigen::MatrixXd> & layer_covariates,
+            const std::vector<std::size_t> & schedule,
+            std::size_t period_length
+        );
+
+        std::size_t nlayers() const { return layers.size(); }
+
+        std::size_t nlocations() const { return layers.front().cols(); }
+
+        std::size_t ncovariates() const { return layers.front().rows(); }
+
+        /**
+         * Position of time step t within the schedule
+        */
+        std::size_t period(std::size_t t) const {
+            return (t / steps_per_period) % period_layers.size();
+        }
+
+        /**
+         * Layer active at time step t
+        */
+        std::size_t layer(std::size_t t) const {
+            return period_layers[period(t)];
+        }
+
+        const Eigen::MatrixXd & covariates(std::size_t layer) const {
+            return layers[layer];
+        }
+
+        /**
+         * Evaluate Hewitt et. al. (2023) eq. 14 for all locations using a
+         * layer's covariates, scaled by a uniformization constant.  Rates are
+         * indexed by Location::index.
+        */
+        const Eigen::VectorXd & transition_rates(
+            std::size_t layer, const Eigen::VectorXd & beta, double delta
+        );
+
+};
+
+/**
+ * Location-based transition rates whose covariates vary over time, selecting
+ * the rate table for the layer active at the current time step.  The time
+ * step must be set before particles are moved, i.e., via
+ * TimeVaryingStepProposal objects.
+*/
+template<typename State>
+class time_varying_location_based_movement {
+
+    private:
+
+        CovariateStack * m_stack;
+        const double * m_rates;
+
+        Eigen::VectorXd beta;
+        double delta;
+
+    public:
+
+        /**
+         * @param stack covariate layers and schedule
+         * @param b location-based movement parameters
+         * @param uniformization uniformization constant for the rates
+        */
+        time_varying_location_based_movement(
+            CovariateStack & stack, const Eigen::VectorXd & b,
+            double uniformization
+        ) : m_stack(&stack), m_rates(nullptr), beta(b),
+            delta(uniformization) {
+            set_time(0);
+        }
+
+        /**
+         * Activate the rate table for time step t
+        */
+        void set_time(std::size_t t) {
+            m_rates = m_stack->transition_rates(
+                m_stack->layer(t), beta, delta
+            ).data();
+        }
+
+        double transition_rate(const State & state) const {
+            return m_rates[state.properties.location->index];
+        }
+
+};
+
+/**
+ * Proposal distribution that moves a particle one step using the transition
+ * rates for a specific time step
+*/
+template<typename Particle, typename RateEvaluator>
+class TimeVaryingStepProposal {
+
+    private:
+
+        RateEvaluator * m_rate_evaluator;
+        std::size_t timepoint;
+
+    public:
+
+        TimeVaryingStepProposal(RateEvaluator & rate_evaluator, std::size_t t) :
+            m_rate_evaluator(&rate_evaluator), timepoint(t) { }
+
+        double propose(Particle & particle) {
+            m_rate_evaluator->set_time(timepoint);
+            particle.step();
+            return 0;
+        }
+
+};
+
+/**
+ * Create a family of proposal distributions that move particles one step for
+ * each of nt discrete timepoints, using the rates for each timepoint
+*/
+template<typename Particle, typename RateEvaluator>
+std::vector<TimeVaryingStepProposal<Particle, RateEvaluator>>
+TimeVaryingStepFamily(RateEvaluator & rate_evaluator, std::size_t nt) {
+    std::vector<TimeVaryingStepProposal<Particle, RateEvaluator>> family;
+    family.reserve(nt);
+    for(std::size_t t = 0; t < nt; ++t) {
+        family.emplace_back(rate_evaluator, t);
+    }
+    return family;
+}
+
+#endif
@@ -0,0 +1,50 @@
+#include "DirectionalBias.h"
+
+/**
+ * Precompute the directional covariates for each link in a statespace, i.e.,
+ * to model directional bias toward or away from spatial features
+ *
+ * @param statespace Object constructed from \code{build_statespace}
+ * @param directional_covariates matrix with the same layout as the
+ *   covariates used to build the statespace, whose rows are covariates whose
+ *   gradients drive the direction of movement, e.g., distance to water
+*/
+// [[Rcpp::export]]
+Rcpp::XPtr<RookDirectionalBias> build_directional_bias(
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::NumericMatrix directional_covariates
+) {
+    Eigen::Map<Eigen::MatrixXd> covariates(
+        directional_covariates.begin(), directional_covariates.nrow(),
+        directional_covariates.ncol()
+    );
+    return Rcpp::XPtr<RookDirectionalBias>(
+        new RookDirectionalBias(
+            *statespace, statespace->location_columns(covariates)
+        ),
+        true
+    );
+}
+
+/**
+ * Transition probabilities for each link in a statespace with directional
+ * bias
+ *
+ * @param bias Object constructed from \code{build_directional_bias}
+ * @param directional_persistence strength of directional persistence
+ * @param gamma coefficients for the directional covariates
+ * @return vector of probabilities in the order of the neighbor_ids from
+ *   \code{statespace_columns}
+*/
+// [[Rcpp::export]]
+Rcpp::NumericVector directional_bias_probabilities(
+    Rcpp::XPtr<RookDirectionalBias> bias, double directional_persistence,
+    Eigen::VectorXd gamma
+) {
+    if(static_cast<std::size_t>(gamma.size()) != bias->ncovariates()) {
+        Rcpp::stop("Argument gamma has the wrong length");
+    }
+    bias->set_parameters(directional_persistence, gamma);
+    const Eigen::VectorXd & p = bias->link_probabilities();
+    return Rcpp::NumericVector(p.data(), p.data() + p.size());
+}
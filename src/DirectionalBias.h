@@ -0,0 +1,153 @@
+/**
+ * Transition probabilities with covariate-driven directional bias, i.e.,
+ * movement toward water or away from roads
+*/
+
+#ifndef MOVECON_DIRECTIONAL_BIAS_H
+#define MOVECON_DIRECTIONAL_BIAS_H
+
+// [[Rcpp::depends(RcppEigen)]]
+
+#include <RcppEigen.h>
+
+#include "Domain.h"
+#include "Directions.h"
+#include "TransitionTable.h"
+
+#include <cmath>
+
+/**
+ * Evaluate Hewitt et. al. (2023) eq. 15 with directional persistence and
+ * directional drivers of movement.  The probability that a transition uses a
+ * link is proportional to
+ *
+ *   exp(directional_persistence * c + gamma' z),
+ *
+ * in which c is the link's directional persistence covariate, and z is the
+ * directional derivative of the directional covariates along the link, i.e.,
+ * the dot product between the covariates' gradients and the direction of
+ * movement, approximated by finite differences between the link's locations.
+ *
+ * The links' covariates do not depend on model parameters, so they are
+ * computed once and stored contiguously, with the links for each state
+ * starting at offsets[State::index] and following the order of the state's
+ * "to" links.  Updating model parameters re-evaluates all transition
+ * probabilities in a single pass over the links.  Objects can serve as the
+ * transition_probability_evaluator for particles, but updating parameters
+ * writes to the table, so a table must not be updated while particles use it.
+*/
+template<typename DirectionalPersistence>
+class DirectionalBiasTable {
+
+    private:
+
+        std::vector<std::size_t> offsets;
+
+        // directional persistence covariate for each link
+        Eigen::VectorXd persistence_covariates;
+
+        // contrasts.col(k) holds the directional covariates for link k
+        Eigen::MatrixXd contrasts;
+
+        Eigen::VectorXd probabilities_table;
+
+    public:
+
+        /**
+         * @param statespace statespace with indexed states and locations
+         * @param location_covariates matrix whose columns are the directional
+         *   covariates for each location, in order of Location::index
+        */
+        template<typename Statespace>
+        DirectionalBiasTable(
+            const Statespace & statespace,
+            const Eigen::Ref<const Eigen::MatrixXd> & location_covariates
+        ) : offsets(transition_offsets(statespace)),
+            persistence_covariates(offsets.back()),
+            contrasts(location_covariates.rows(), offsets.back()),
+            probabilities_table(offsets.back()) {
+
+            for(auto & entry : statespace.states) {
+                auto & state = entry.second;
+                const Location * source = state.properties.location;
+                std::size_t k = offsets[state.index];
+                for(auto destination : state.to) {
+                    const Location * target =
+                        destination->properties.location;
+                    persistence_covariates(k) = DirectionalPersistence::
+                        directional_persistence_covariate(
+                            state.properties.last_movement_direction,
+                            destination->properties.last_movement_direction
+                        );
+                    double length = std::sqrt(
+                        std::pow(target->easting - source->easting, 2) +
+                        std::pow(target->northing - source->northing, 2)
+                    );
+                    contrasts.col(k++) = (
+                        location_covariates.col(target->index) -
+                        location_covariates.col(source->index)
+                    ) / length;
+                }
+            }
+
+            set_parameters(0, Eigen::VectorXd::Zero(contrasts.rows()));
+        }
+
+        std::size_t ncovariates() const { return contrasts.rows(); }
+
+        std::size_t nstates() const { return offsets.size() - 1; }
+
+        std::size_t nlinks() const { return offsets.back(); }
+
+        /**
+         * Re-evaluate the transition probabilities for new model parameters
+         *
+         * @param directional_persistence strength of directional persistence
+         * @param gamma coefficients for the directional covariates
+        */
+        void set_parameters(
+            double directional_persistence,
+            const Eigen::Ref<const Eigen::VectorXd> & gamma
+        ) {
+
+            // linear predictors for all links
+            probabilities_table.noalias() = contrasts.transpose() * gamma;
+            probabilities_table += directional_persistence *
+                persistence_covariates;
+
+            // standardize transition distributions
+            std::size_t nstates = offsets.size() - 1;
+            for(std::size_t i = 0; i < nstates; ++i) {
+                std::size_t n = offsets[i + 1] - offsets[i];
+                if(n == 0) {
+                    continue;
+                }
+                auto p = probabilities_table.segment(offsets[i], n);
+                p = (p.array() - p.maxCoeff()).exp();
+                p /= p.sum();
+            }
+        }
+
+        template<typename State>
+        Eigen::Map<const Eigen::VectorXd> probabilities(
+            const State & state
+        ) const {
+            return Eigen::Map<const Eigen::VectorXd>(
+                probabilities_table.data() + offsets[state.index],
+                state.to.size()
+            );
+        }
+
+        /**
+         * Transition probabilities for all links
+        */
+        const Eigen::VectorXd & link_probabilities() const {
+            return probabilities_table;
+        }
+
+};
+
+typedef DirectionalBiasTable<CardinalDirectionOrientations>
+    RookDirectionalBias;
+
+#endif
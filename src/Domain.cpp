@@ -1,5 +1,8 @@
 #include "Domain.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 RookDirectionalStatespace::RookDirectionalStatespace(
     const Rcpp::NumericVector & eastings, 
     const Rcpp::NumericVector & northings,
@@ -13,12 +16,14 @@ RookDirectionalStatespace::RookDirectionalStatespace(
     */
 
     // direction of north/east with respect to grid
-    int north_step = northings[1] - northings[0] > 0 ? 1 : -1;
-    int east_step = eastings[1] - eastings[0] > 0 ? 1 : -1;
+    north_step = northings[1] - northings[0] > 0 ? 1 : -1;
+    east_step = eastings[1] - eastings[0] > 0 ? 1 : -1;
 
     // extract grid metadata
     std::size_t eastings_len = eastings.size();
     std::size_t northings_len = northings.size();
+    neastings = eastings_len;
+    nnorthings = northings_len;
     double min_easting, max_easting, min_northing, max_northing;
     if(north_step == 1) {
         min_northing = northings[0];
@@ -66,6 +71,66 @@ RookDirectionalStatespace::RookDirectionalStatespace(
         }
     }
 
+    build_states();
+}
+
+RookDirectionalStatespace::RookDirectionalStatespace(
+    const RookDirectionalStatespace & statespace, std::size_t k
+) : north_step(statespace.north_step), east_step(statespace.east_step) {
+
+    if(k == 0) {
+        Rcpp::stop("Coarsening factor must be positive");
+    }
+
+    neastings = (statespace.neastings + k - 1) / k;
+    nnorthings = (statespace.nnorthings + k - 1) / k;
+
+    // fine cells that each coarse cell aggregates
+    std::map<LocationIndices, std::vector<const Location *>> blocks;
+    for(auto & map_entry : statespace.grid) {
+        blocks[LocationIndices(
+            map_entry.first.first / k, map_entry.first.second / k
+        )].push_back(&map_entry.second);
+    }
+
+    // coarse cells own their covariates, which are stored contiguously
+    std::size_t p = statespace.grid.empty() ? 
+        0 : statespace.grid.begin()->second.x.size();
+    covariate_storage.resize(blocks.size() * p);
+    double * covariates_it = covariate_storage.data();
+
+    for(auto & block : blocks) {
+
+        // average the coordinates and covariates of the block's cells
+        Location & cell = grid[block.first];
+        new (&(cell.x)) Eigen::Map<Eigen::VectorXd>(covariates_it, p);
+        cell.easting = 0;
+        cell.northing = 0;
+        cell.x.setZero();
+        for(auto fine_cell : block.second) {
+            cell.easting += fine_cell->easting;
+            cell.northing += fine_cell->northing;
+            cell.x += fine_cell->x;
+        }
+        double n = static_cast<double>(block.second.size());
+        cell.easting /= n;
+        cell.northing /= n;
+        cell.x /= n;
+
+        covariates_it += p;
+    }
+
+    build_states();
+}
+
+void RookDirectionalStatespace::build_states() {
+
+    // enumerate locations in key order
+    std::size_t location_index = 0;
+    for(auto& map_entry : grid) {
+        map_entry.second.index = location_index++;
+    }
+
     // initialize states associated with grid cells
     for(auto& map_entry : grid) {
 
@@ -122,12 +187,16 @@ RookDirectionalStatespace::RookDirectionalStatespace(
 
     // initialize connections between states 
     // (i.e., link allowable movement combinations on the grid)
+    std::size_t state_index = 0;
     for(auto& map_entry : states) {
 
         std::size_t easting_ind = std::get<1>(map_entry.first);
         std::size_t northing_ind = std::get<2>(map_entry.first);
         StateType & state = map_entry.second;
 
+        // enumerate states in key order
+        state.index = state_index++;
+
         // define movement keys
         StateKey eastern_movement = StateKey(
             east, easting_ind + east_step, northing_ind
@@ -184,6 +253,73 @@ RookDirectionalStatespace::RookDirectionalStatespace(
     }
 }
 
+std::vector<RookDirectionalStatespace::StateType*> 
+RookDirectionalStatespace::coarsen_states(
+    const RookDirectionalStatespace & statespace, 
+    const std::vector<StateType*> & fine_states, std::size_t k
+) {
+
+    // grid indices for each of the fine statespace's locations
+    std::map<const Location *, LocationIndices> fine_indices;
+    for(auto & map_entry : statespace.grid) {
+        fine_indices[&map_entry.second] = map_entry.first;
+    }
+
+    std::vector<StateType*> res;
+    res.reserve(fine_states.size());
+    for(auto fine_state : fine_states) {
+        auto indices = fine_indices.find(fine_state->properties.location);
+        if(indices == fine_indices.end()) {
+            continue;
+        }
+        std::size_t easting_ind = indices->second.first / k;
+        std::size_t northing_ind = indices->second.second / k;
+        // prefer the state that preserves the direction of movement
+        auto state = states.find(StateKey(
+            fine_state->properties.last_movement_direction, easting_ind, 
+            northing_ind
+        ));
+        if(state == states.end()) {
+            for(auto direction : {north, east, south, west}) {
+                state = states.find(
+                    StateKey(direction, easting_ind, northing_ind)
+                );
+                if(state != states.end()) {
+                    break;
+                }
+            }
+        }
+        if(state != states.end()) {
+            res.push_back(&(state->second));
+        }
+    }
+
+    return res;
+}
+
+Eigen::MatrixXd RookDirectionalStatespace::location_columns(
+    const Eigen::Ref<const Eigen::MatrixXd> & values
+) const {
+    if(static_cast<std::size_t>(values.cols()) != neastings * nnorthings) {
+        Rcpp::stop("Location data must have one column for each grid cell");
+    }
+    Eigen::MatrixXd res(values.rows(), grid.size());
+    for(auto & map_entry : grid) {
+        res.col(map_entry.second.index) = values.col(
+            map_entry.first.first + neastings * map_entry.first.second
+        );
+    }
+    return res;
+}
+
+void RookDirectionalStatespace::reset_transition_cache() {
+    auto end = states.end();
+    for(auto state = states.begin(); state != end; ++state) {
+        state->second.to_rate = -1;
+        state->second.to_probabilities_cached = false;
+    }
+}
+
 /**
  * Create a linked-list representation of a discrete state space for persistent
  * movement with rook adjacencies.  Returns an Rcpp::XPtr to the linked-list in
@@ -213,6 +349,76 @@ Rcpp::XPtr<RookDirectionalStatespace> build_statespace(
     return Rcpp::XPtr<RookDirectionalStatespace>(statespace, true);
 }
 
+/**
+ * Aggregate a statespace onto a coarser grid.  Returns an Rcpp::XPtr to the 
+ * coarsened statespace in C++.
+ * 
+ * Each coarse cell combines a k x k block of cells from the original grid.  
+ * The coarse cell's coordinates and covariates are the averages over the 
+ * block's cells that belong to the original statespace, and blocks without 
+ * any such cells are excluded.
+ * 
+ * @param statespace Object constructed from \code{build_statespace}
+ * @param k number of cells to aggregate along each grid axis
+*/
+// [[Rcpp::export]]
+Rcpp::XPtr<RookDirectionalStatespace> build_coarse_statespace(
+    Rcpp::XPtr<RookDirectionalStatespace> statespace, std::size_t k
+) {
+    RookDirectionalStatespace * coarse = new RookDirectionalStatespace(
+        *statespace, k
+    );
+    return Rcpp::XPtr<RookDirectionalStatespace>(coarse, true);
+}
+
+/**
+ * Locations and most recent movement directions for all states in a CTDS 
+ * domain object, ordered by state id, i.e., to interpret state ids recorded 
+ * by \code{Particle_Filter_State_Ids_From_GPS}.  Entry i describes the state 
+ * with 0-based id i-1.
+ * 
+ * @param statespace Object constructed from \code{build_statespace}
+*/
+// [[Rcpp::export]]
+Rcpp::List statespace_state_locations(
+    Rcpp::XPtr<RookDirectionalStatespace> statespace
+) {
+    std::size_t n = statespace->states.size();
+    Rcpp::NumericVector easting(n), northing(n);
+    Rcpp::CharacterVector last_movement_direction(n);
+    for(auto & map_entry : statespace->states) {
+        const RookDirectionalStatespace::StateType & state = map_entry.second;
+        easting[state.index] = state.properties.location->easting;
+        northing[state.index] = state.properties.location->northing;
+        last_movement_direction[state.index] = directionToString(
+            state.properties.last_movement_direction
+        );
+    }
+    return Rcpp::List::create(
+        Rcpp::Named("easting") = easting,
+        Rcpp::Named("northing") = northing,
+        Rcpp::Named("last_movement_direction") = last_movement_direction
+    );
+}
+
+/**
+ * State ids, i.e., 0-based indices into \code{statespace_state_locations}, 
+ * for a sample of states
+ * 
+ * @param states Object constructed from, e.g., 
+ *   \code{sample_gaussian_states_from_hdop_uere}
+*/
+// [[Rcpp::export]]
+Rcpp::IntegerVector state_sample_ids(
+    Rcpp::XPtr<std::vector<RookDirectionalStatespace::StateType*>> states
+) {
+    Rcpp::IntegerVector ids(states->size());
+    for(std::size_t i = 0; i < states->size(); ++i) {
+        ids[i] = (*states)[i]->index;
+    }
+    return ids;
+}
+
 /**
  * Format a location object for viewing within R
 */
@@ -301,3 +507,145 @@ Rcpp::List extract_statespace_state(
     );
     return format_state(state);   
 }
+
+/**
+ * Export a CTDS domain object as columnar arrays, i.e., to inspect or plot 
+ * large statespaces without building nested lists for each state.
+ * 
+ * Returns a list with entries:
+ * \itemize{
+ *   \item{states}{data frame with one row for each state, ordered by 0-based 
+ *     state id, giving the state's last movement direction, 0-based 
+ *     location index, and location coordinates}
+ *   \item{locations}{data frame with one row for each location, ordered by 
+ *     0-based location index, giving the location's coordinates and 0-based 
+ *     grid indices}
+ *   \item{covariates}{matrix whose columns are the locations' covariates}
+ *   \item{neighbor_offsets,neighbor_ids}{0-based ids of the states that 
+ *     each state may transition to, in compressed sparse row format with 
+ *     0-based offsets, as for the \code{p} and \code{j} slots of a 
+ *     dgRMatrix.  Each state's neighbors are listed in the same order as 
+ *     its transition probabilities.}
+ *   \item{transitions}{dgCMatrix whose non-zero entries (i, j) indicate that 
+ *     state i may transition to state j}
+ * }
+ * 
+ * @param statespace Object constructed from \code{build_statespace}
+*/
+// [[Rcpp::export]]
+Rcpp::List statespace_columns(
+    Rcpp::XPtr<RookDirectionalStatespace> statespace
+) {
+    typedef RookDirectionalStatespace::StateType StateType;
+
+    //
+    // locations
+    //
+
+    std::size_t nlocations = statespace->grid.size();
+    std::size_t ncovariates = nlocations > 0 ? 
+        statespace->grid.begin()->second.x.size() : 0;
+
+    Rcpp::NumericVector location_easting(nlocations);
+    Rcpp::NumericVector location_northing(nlocations);
+    Rcpp::IntegerVector easting_ind(nlocations), northing_ind(nlocations);
+    Rcpp::NumericMatrix covariates(ncovariates, nlocations);
+    std::unordered_map<const Location*, std::size_t> location_index;
+    location_index.reserve(nlocations);
+
+    std::size_t l = 0;
+    for(auto & map_entry : statespace->grid) {
+        const Location & location = map_entry.second;
+        location_index[&location] = l;
+        location_easting[l] = location.easting;
+        location_northing[l] = location.northing;
+        easting_ind[l] = map_entry.first.first;
+        northing_ind[l] = map_entry.first.second;
+        std::copy(
+            location.x.data(), location.x.data() + ncovariates, 
+            covariates.begin() + l * ncovariates
+        );
+        ++l;
+    }
+
+    //
+    // states and forward transitions
+    //
+
+    std::size_t nstates = statespace->states.size();
+
+    Rcpp::CharacterVector last_movement_direction(nstates);
+    Rcpp::IntegerVector state_location(nstates);
+    Rcpp::NumericVector state_easting(nstates), state_northing(nstates);
+    Rcpp::IntegerVector neighbor_offsets(nstates + 1);
+
+    // states, by state id
+    std::vector<const StateType*> states(nstates);
+    std::size_t nneighbors = 0;
+    for(auto & map_entry : statespace->states) {
+        const StateType & state = map_entry.second;
+        states[state.index] = &state;
+        nneighbors += state.to.size();
+    }
+
+    Rcpp::IntegerVector neighbor_ids(nneighbors);
+    std::size_t k = 0;
+    for(std::size_t i = 0; i < nstates; ++i) {
+        const StateType & state = *states[i];
+        last_movement_direction[i] = directionToString(
+            state.properties.last_movement_direction
+        );
+        state_location[i] = location_index.at(state.properties.location);
+        state_easting[i] = state.properties.location->easting;
+        state_northing[i] = state.properties.location->northing;
+        // neighbors in the order of the state's transition probabilities
+        neighbor_offsets[i] = k;
+        for(auto destination : state.to) {
+            neighbor_ids[k++] = destination->index;
+        }
+    }
+    neighbor_offsets[nstates] = k;
+
+    //
+    // transition structure, with one column of sources for each destination
+    //
+
+    Rcpp::IntegerVector p(nstates + 1), i(nneighbors);
+    Rcpp::NumericVector x(nneighbors, 1.0);
+    k = 0;
+    for(std::size_t j = 0; j < nstates; ++j) {
+        p[j] = k;
+        std::size_t column_start = k;
+        for(auto source : states[j]->from) {
+            i[k++] = source->index;
+        }
+        std::sort(i.begin() + column_start, i.begin() + k);
+    }
+    p[nstates] = k;
+
+    Rcpp::S4 transitions("dgCMatrix");
+    transitions.slot("i") = i;
+    transitions.slot("p") = p;
+    transitions.slot("x") = x;
+    transitions.slot("Dim") = Rcpp::IntegerVector::create(nstates, nstates);
+
+    return Rcpp::List::create(
+        Rcpp::Named("states") = Rcpp::DataFrame::create(
+            Rcpp::Named("last_movement_direction") = last_movement_direction,
+            Rcpp::Named("location") = state_location,
+            Rcpp::Named("easting") = state_easting,
+            Rcpp::Named("northing") = state_northing,
+            Rcpp::Named("stringsAsFactors") = false
+        ),
+        Rcpp::Named("locations") = Rcpp::DataFrame::create(
+            Rcpp::Named("easting") = location_easting,
+            Rcpp::Named("northing") = location_northing,
+            Rcpp::Named("easting_ind") = easting_ind,
+            Rcpp::Named("northing_ind") = northing_ind
+        ),
+        Rcpp::Named("covariates") = covariates,
+        Rcpp::Named("neighbor_offsets") = neighbor_offsets,
+        Rcpp::Named("neighbor_ids") = neighbor_ids,
+        Rcpp::Named("transitions") = transitions
+    );
+}
@@ -23,6 +23,10 @@ struct Location {
     // covariates
     Eigen::Map<Eigen::VectorXd> x{nullptr, 0};
 
+    // position of the location within its statespace's grid, i.e., to index 
+    // tables of location-based values
+    std::size_t index = 0;
+
     friend bool operator<(const Location & lhs, const Location & rhs) {
         return std::tie(lhs.easting, lhs.northing) < 
                std::tie(rhs.easting, rhs.northing);
@@ -77,6 +81,12 @@ struct State {
     // probability that neighbors will be visited during a transition
     Eigen::VectorXd to_probabilities;
 
+    // true if to_probabilities holds values for the current model parameters
+    bool to_probabilities_cached = false;
+
+    // position of the state within its statespace, i.e., to index tables
+    std::size_t index = 0;
+
     friend bool operator<(const SelfType & lhs, const SelfType & rhs) {
         return lhs.properties < rhs.properties;
     }
@@ -101,6 +111,19 @@ struct RookDirectionalStatespace {
     typedef State<LocalMovement> StateType;
     std::map<StateKey, StateType> states;
 
+    // direction of north/east with respect to the grid indices
+    int north_step = 1;
+    int east_step = 1;
+
+    // number of easting and northing coordinates that define the grid, 
+    // including locations excluded by the linear constraint
+    std::size_t neastings = 0;
+    std::size_t nnorthings = 0;
+
+    // covariates for statespaces that own their covariate data, i.e., 
+    // coarsened statespaces; empty if covariates are owned externally
+    std::vector<double> covariate_storage;
+
     /**
      * Linked-list representation of a discrete state space for persistent 
      * movement with rook adjacencies.
@@ -132,9 +155,94 @@ struct RookDirectionalStatespace {
         Rcpp::NumericMatrix & covariates,
         Rcpp::NumericVector & linear_constraint
     );
+
+    /**
+     * Aggregate a statespace onto a coarser grid, i.e., to build a cheap 
+     * surrogate for the original statespace.
+     * 
+     * Coarse cell (I, J) combines the original cells (i, j) for which 
+     * i / k = I and j / k = J, using integer division.  The coarse cell's 
+     * coordinates and covariates are the averages over the combined cells, 
+     * and the coarse statespace owns its covariate data.
+     * 
+     * @param statespace statespace to coarsen
+     * @param k number of cells to aggregate along each grid axis
+    */
+    RookDirectionalStatespace(
+        const RookDirectionalStatespace & statespace, std::size_t k
+    );
+
+    RookDirectionalStatespace(const RookDirectionalStatespace &) = delete;
+    RookDirectionalStatespace & operator=(
+        const RookDirectionalStatespace &
+    ) = delete;
+
+    /**
+     * Map states from a statespace onto this statespace, after this 
+     * statespace was built by coarsening the other statespace by a factor k.
+     * Each state maps to the state for the coarse cell that contains its 
+     * location, preferring the state with the same direction of movement. 
+     * States without a counterpart are dropped.
+    */
+    std::vector<StateType*> coarsen_states(
+        const RookDirectionalStatespace & statespace, 
+        const std::vector<StateType*> & fine_states, std::size_t k
+    );
+
+    /**
+     * Extract the columns of a matrix for the statespace's locations, in 
+     * order of Location::index, i.e., to associate additional location-based 
+     * data with the statespace
+     * 
+     * @param values matrix with the same layout as the covariates used to 
+     *   build the statespace, i.e., one column for each grid cell, including 
+     *   cells excluded from the statespace
+    */
+    Eigen::MatrixXd location_columns(
+        const Eigen::Ref<const Eigen::MatrixXd> & values
+    ) const;
+
+    /**
+     * Flag the transition rates and probabilities cached in each state as 
+     * stale, i.e., after model parameters change.  Storage for cached values 
+     * is retained so that it can be reused.
+    */
+    void reset_transition_cache();
+
+    /**
+     * Evaluate and cache the transition rates and probabilities for all
+     * states, i.e., so that particles can be propagated from several threads
+     * without writing to the shared statespace.
+     *
+     * @param rate_evaluator state_cache_rate_evaluator for the model
+     * @param probability_evaluator
+     *   state_cache_transition_probability_evaluator for the model
+    */
+    template<typename RateEvaluator, typename ProbabilityEvaluator>
+    void prime_transition_cache(
+        RateEvaluator & rate_evaluator,
+        ProbabilityEvaluator & probability_evaluator
+    ) {
+        auto end = states.end();
+        for(auto state = states.begin(); state != end; ++state) {
+            rate_evaluator.transition_rate(state->second);
+            probability_evaluator.probabilities(state->second);
+        }
+    }
+
+    private:
+
+    /**
+     * Create states for the grid cells and link the states that are 
+     * connected by rook moves
+    */
+    void build_states();
 };
 
 Rcpp::List format_state(const RookDirectionalStatespace::StateType & state);
 Rcpp::List format_location(const Location & location);
+Rcpp::List statespace_state_locations(
+    Rcpp::XPtr<RookDirectionalStatespace> statespace
+);
 
 #endif //MOVECON_DOMAIN_H
@@ -28,16 +28,72 @@ Rcpp::List states_at_nearest_location_in_domain(
     typedef RookDirectionalStatespace::StateType StateType;
 
     Location * location = statespace_search->map_location(easting, northing);
-    std::set<StateType*> states = 
-        statespace_search->states_by_location[location];
 
     Rcpp::List res;
 
-    auto state = states.begin();
-    auto state_end = states.end();
-    for(; state != state_end; ++state) {
-        res.push_back(format_state(**state));
+    for(StateType * state : statespace_search->states_at(location)) {
+        res.push_back(format_state(*state));
     }
 
     return res;
 }
+
+// [[Rcpp::export]]
+Rcpp::List nearest_locations_in_domain(
+    Rcpp::XPtr<RookDirectionalStatespaceSearch> statespace_search, 
+    Rcpp::NumericVector eastings,
+    Rcpp::NumericVector northings,
+    std::size_t nthreads = 1
+) {
+
+    if(eastings.size() != northings.size()) {
+        Rcpp::stop("Arguments eastings and northings must have equal length");
+    }
+
+    std::size_t n = eastings.size();
+    std::vector<std::size_t> ids(n);
+    statespace_search->map_location_ids(
+        eastings.begin(), northings.begin(), n, ids.data(), nthreads
+    );
+
+    // export 1-based location ids and coordinates
+    std::size_t nlocations = statespace_search->n_locations();
+    Rcpp::IntegerVector location_ids(n);
+    Rcpp::NumericVector location_eastings(n);
+    Rcpp::NumericVector location_northings(n);
+    for(std::size_t i = 0; i < n; ++i) {
+        if(ids[i] < nlocations) {
+            Location * location = statespace_search->locations[ids[i]];
+            location_ids[i] = ids[i] + 1;
+            location_eastings[i] = location->easting;
+            location_northings[i] = location->northing;
+        } else {
+            location_ids[i] = NA_INTEGER;
+            location_eastings[i] = NA_REAL;
+            location_northings[i] = NA_REAL;
+        }
+    }
+
+    return Rcpp::List::create(
+        Rcpp::Named("location_id") = location_ids,
+        Rcpp::Named("easting") = location_eastings,
+        Rcpp::Named("northing") = location_northings
+    );
+}
+
+// [[Rcpp::export]]
+Rcpp::List statespace_search_locations(
+    Rcpp::XPtr<RookDirectionalStatespaceSearch> statespace_search
+) {
+    std::size_t n = statespace_search->n_locations();
+    Rcpp::NumericVector eastings(n);
+    Rcpp::NumericVector northings(n);
+    for(std::size_t i = 0; i < n; ++i) {
+        eastings[i] = statespace_search->locations[i]->easting;
+        northings[i] = statespace_search->locations[i]->northing;
+    }
+    return Rcpp::List::create(
+        Rcpp::Named("easting") = eastings,
+        Rcpp::Named("northing") = northings
+    );
+}
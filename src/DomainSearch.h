@@ -11,9 +11,13 @@
 
 #include <boost/geometry.hpp>
 #include <boost/geometry/geometries/point.hpp>
+#include <boost/geometry/geometries/box.hpp>
 #include <boost/geometry/index/rtree.hpp>
 
 #include "Domain.h"
+#include "ThreadPool.h"
+
+#include <unordered_map>
 
 namespace bg = boost::geometry;
 namespace bgi = boost::geometry::index;
@@ -28,36 +32,498 @@ class StatespaceSearch {
         typedef std::pair<point, Location*> rtree_value;
         bgi::rtree<rtree_value, bgi::rstar<16>> domain_location_tree;
 
+        // reverse lookup for location ids
+        std::unordered_map<const Location*, std::size_t> location_ids;
+
+        // states at each location, by location id, in compressed sparse row
+        // format
+        std::vector<std::size_t> state_offsets;
+        std::vector<typename Statespace::StateType*> location_states;
+
+        // regular lattice that contains the locations, which allows nearest
+        // locations to be found arithmetically: lattice cell (i, j) is 
+        // centered at (easting0 + i * easting_step, northing0 + j * 
+        // northing_step), and cells are numbered i + neastings * j
+        bool regular = false;
+        double easting0, northing0, easting_step, northing_step;
+        std::size_t neastings, nnorthings;
+
+        // location at each lattice cell, or nullptr if the cell is not part
+        // of the domain, and the nearest location to each cell's center
+        std::vector<Location*> cell_location;
+        std::vector<Location*> nearest_cell;
+
+        // maximum number of lattice cells to scan for exact lookups of 
+        // coordinates outside the domain before using the R-tree
+        static constexpr std::size_t max_lattice_scan = 64;
+
+        static double distance2(
+            const Location & location, double easting, double northing
+        ) {
+            double de = location.easting - easting;
+            double dn = location.northing - northing;
+            return de * de + dn * dn;
+        }
+
+        /**
+         * Find the lattice that contains the locations, given by their grid 
+         * indices, and tabulate the 
+         * nearest location to each lattice cell via a Euclidean distance 
+         * transform (Felzenszwalb and Huttenlocher, 2012, doi: 
+         * 10.4086/toc.2012.v008a019).  Lookups fall back to the R-tree if 
+         * the locations do not lie on a regular lattice.
+        */
+        void build_lattice(
+            const std::map<typename Statespace::LocationIndices, Location*> &
+                cells
+        ) {
+
+            if(cells.empty()) {
+                return;
+            }
+
+            // lattice extents and spacing
+            std::size_t i_min = cells.begin()->first.first, i_max = i_min;
+            std::size_t j_min = cells.begin()->first.second, j_max = j_min;
+            const Location * i_min_cell = cells.begin()->second;
+            const Location * i_max_cell = i_min_cell;
+            const Location * j_min_cell = i_min_cell;
+            const Location * j_max_cell = i_min_cell;
+            for(auto & cell : cells) {
+                std::size_t i = cell.first.first, j = cell.first.second;
+                if(i < i_min) { i_min = i; i_min_cell = cell.second; }
+                if(i > i_max) { i_max = i; i_max_cell = cell.second; }
+                if(j < j_min) { j_min = j; j_min_cell = cell.second; }
+                if(j > j_max) { j_max = j; j_max_cell = cell.second; }
+            }
+            if(i_min == i_max || j_min == j_max) {
+                return;
+            }
+            neastings = i_max - i_min + 1;
+            nnorthings = j_max - j_min + 1;
+            easting0 = i_min_cell->easting;
+            northing0 = j_min_cell->northing;
+            easting_step = (i_max_cell->easting - easting0) / (i_max - i_min);
+            northing_step = 
+                (j_max_cell->northing - northing0) / (j_max - j_min);
+            if(easting_step == 0 || northing_step == 0) {
+                return;
+            }
+
+            // all locations must lie at their lattice cells' centers
+            cell_location.assign(neastings * nnorthings, nullptr);
+            double tol = 1e-6;
+            for(auto & cell : cells) {
+                std::size_t i = cell.first.first - i_min;
+                std::size_t j = cell.first.second - j_min;
+                double u = (cell.second->easting - easting0) / easting_step;
+                double v = (cell.second->northing - northing0) / northing_step;
+                if(std::fabs(u - i) > tol || std::fabs(v - j) > tol) {
+                    return;
+                }
+                cell_location[i + neastings * j] = cell.second;
+            }
+
+            // nearest location within each row, and its squared distance
+            std::vector<std::size_t> row_nearest(neastings * nnorthings);
+            std::vector<double> row_dist(neastings * nnorthings, R_PosInf);
+            double de2 = easting_step * easting_step;
+            for(std::size_t j = 0; j < nnorthings; ++j) {
+                std::size_t row = neastings * j;
+                // sweep east, then west, along the row
+                bool found = false;
+                std::size_t last = 0;
+                for(std::size_t i = 0; i < neastings; ++i) {
+                    if(cell_location[row + i]) {
+                        found = true;
+                        last = i;
+                    }
+                    if(found) {
+                        row_nearest[row + i] = last;
+                        row_dist[row + i] = de2 * (i - last) * (i - last);
+                    }
+                }
+                found = false;
+                for(std::size_t i = neastings; i-- > 0; ) {
+                    if(cell_location[row + i]) {
+                        found = true;
+                        last = i;
+                    }
+                    double d = de2 * (last - i) * (last - i);
+                    if(found && d < row_dist[row + i]) {
+                        row_nearest[row + i] = last;
+                        row_dist[row + i] = d;
+                    }
+                }
+            }
+
+            // combine rows via the lower envelope of parabolas along each
+            // column
+            nearest_cell.resize(neastings * nnorthings);
+            double dn2 = northing_step * northing_step;
+            std::vector<std::size_t> v(nnorthings);
+            std::vector<double> z(nnorthings + 1);
+            for(std::size_t i = 0; i < neastings; ++i) {
+                auto f = [&](std::size_t j) { 
+                    return row_dist[i + neastings * j]; 
+                };
+                // parabolas for rows that contain locations
+                std::size_t k = 0;
+                bool any = false;
+                for(std::size_t q = 0; q < nnorthings; ++q) {
+                    if(f(q) == R_PosInf) {
+                        continue;
+                    }
+                    if(!any) {
+                        any = true;
+                        v[0] = q;
+                        z[0] = R_NegInf;
+                        z[1] = R_PosInf;
+                        continue;
+                    }
+                    // intersect with the envelope, dropping parabolas that
+                    // the new parabola hides
+                    double s;
+                    while(true) {
+                        s = (f(q) / dn2 + static_cast<double>(q) * q - 
+                            f(v[k]) / dn2 - static_cast<double>(v[k]) * v[k]
+                        ) / (2.0 * q - 2.0 * v[k]);
+                        if(s > z[k]) {
+                            break;
+                        }
+                        --k;
+                    }
+                    ++k;
+                    v[k] = q;
+                    z[k] = s;
+                    z[k + 1] = R_PosInf;
+                }
+                // read the nearest row for each cell off the envelope
+                k = 0;
+                for(std::size_t q = 0; q < nnorthings; ++q) {
+                    while(z[k + 1] < q) {
+                        ++k;
+                    }
+                    std::size_t j = v[k];
+                    nearest_cell[i + neastings * q] = cell_location[
+                        row_nearest[i + neastings * j] + neastings * j
+                    ];
+                }
+            }
+
+            regular = true;
+        }
+
     public:
 
-        // reverse-lookup to index into states by their location
         typedef typename Statespace::StateType StateType;
-        std::map<Location*, std::set<StateType*>> states_by_location;  
+
+        /**
+         * Read-only view of the states at a location
+        */
+        class StateRange {
+
+            private:
+
+                StateType * const * first;
+                StateType * const * last;
+
+            public:
+
+                StateRange(StateType * const * b, StateType * const * e) :
+                    first(b), last(e) { }
+
+                StateType * const * begin() const { return first; }
+                StateType * const * end() const { return last; }
+
+                std::size_t size() const { return last - first; }
+                bool empty() const { return first == last; }
+
+                StateType * operator[](std::size_t i) const {
+                    return first[i];
+                }
+
+        };
+
+        // locations that belong to states, by location id
+        std::vector<Location*> locations;
 
         StatespaceSearch(Statespace & statespace) {
-            // populate R-tree and reverse lookup structures with domain info.
-            auto state = statespace.states.begin();
-            auto state_end = statespace.states.end();
-            for(; state != state_end; ++state) {
-                Location * location = state->second.properties.location;
-                // add location to reverse lookup for states
-                states_by_location[location].insert(&state->second);
-                // add location to rtree
-                point p(location->easting, location->northing);
-                domain_location_tree.insert(std::make_pair(p, location));
+            // locations that belong to states, indexed by grid position
+            std::map<typename Statespace::LocationIndices, Location*> cells;
+            for(auto & map_entry : statespace.states) {
+                cells[typename Statespace::LocationIndices(
+                    std::get<1>(map_entry.first), std::get<2>(map_entry.first)
+                )] = map_entry.second.properties.location;
+            }
+            // number locations by grid position
+            locations.reserve(cells.size());
+            std::vector<rtree_value> values;
+            values.reserve(cells.size());
+            for(auto & cell : cells) {
+                location_ids[cell.second] = locations.size();
+                locations.push_back(cell.second);
+                values.emplace_back(
+                    point(cell.second->easting, cell.second->northing), 
+                    cell.second
+                );
+            }
+            // reverse lookup for states, in compressed sparse row format 
+            // with each location's states in state index order
+            state_offsets.assign(locations.size() + 1, 0);
+            for(auto & map_entry : statespace.states) {
+                ++state_offsets[
+                    location_ids[map_entry.second.properties.location] + 1
+                ];
             }
+            for(std::size_t i = 0; i < locations.size(); ++i) {
+                state_offsets[i + 1] += state_offsets[i];
+            }
+            location_states.resize(state_offsets.back());
+            std::vector<std::size_t> fill(
+                state_offsets.begin(), state_offsets.end() - 1
+            );
+            for(auto & map_entry : statespace.states) {
+                location_states[fill[
+                    location_ids[map_entry.second.properties.location]
+                ]++] = &map_entry.second;
+            }
+            // bulk load the R-tree, which packs each location into the tree 
+            // once via sort-tile-recursion
+            domain_location_tree = bgi::rtree<rtree_value, bgi::rstar<16>>(
+                values.begin(), values.end()
+            );
+            build_lattice(cells);
         }
 
         /**
-         * Return the location closest to the given coordinates
+         * Return the location closest to the given coordinates.  Coordinates 
+         * within the locations' lattice are mapped arithmetically to a 
+         * lattice cell; if the cell is not part of the domain, the nearest 
+         * locations to the lattice square's corners bound the distance to the 
+         * closest location, and the lattice cells within the bound are 
+         * scanned, or the R-tree is searched if the bound spans many cells.
         */
-        Location* map_location(double easting, double northing) {
-            std::vector<rtree_value> res;
+        Location* map_location(double easting, double northing) const {
+            if(regular) {
+                double u = (easting - easting0) / easting_step;
+                double v = (northing - northing0) / northing_step;
+                if(u > -.5 && u < neastings - .5 && 
+                   v > -.5 && v < nnorthings - .5) {
+                    std::size_t i = std::min<std::size_t>(
+                        std::lround(std::max(u, 0.0)), neastings - 1
+                    );
+                    std::size_t j = std::min<std::size_t>(
+                        std::lround(std::max(v, 0.0)), nnorthings - 1
+                    );
+                    Location * nearest = nearest_cell[i + neastings * j];
+                    if(nearest == cell_location[i + neastings * j]) {
+                        return nearest;
+                    }
+                    // the cell is not part of the domain, so also consider
+                    // the locations nearest to the other corners of the 
+                    // lattice square that contains the coordinates, then 
+                    // scan the lattice cells that could hold a closer 
+                    // location, i.e., cells within the best candidate's 
+                    // distance, which keeps the lookup exact
+                    std::size_t i0 = std::min<std::size_t>(
+                        std::max(std::floor(u), 0.0), neastings - 1
+                    );
+                    std::size_t j0 = std::min<std::size_t>(
+                        std::max(std::floor(v), 0.0), nnorthings - 1
+                    );
+                    double d_min = distance2(*nearest, easting, northing);
+                    for(std::size_t i1 = i0; i1 <= i0 + 1; ++i1) {
+                        for(std::size_t j1 = j0; j1 <= j0 + 1; ++j1) {
+                            if(i1 >= neastings || j1 >= nnorthings) {
+                                continue;
+                            }
+                            Location * candidate = 
+                                nearest_cell[i1 + neastings * j1];
+                            double d = 
+                                distance2(*candidate, easting, northing);
+                            if(d < d_min) {
+                                d_min = d;
+                                nearest = candidate;
+                            }
+                        }
+                    }
+                    double r = std::sqrt(d_min);
+                    double du = r / std::fabs(easting_step);
+                    double dv = r / std::fabs(northing_step);
+                    std::size_t i_min = std::max(std::ceil(u - du), 0.0);
+                    std::size_t j_min = std::max(std::ceil(v - dv), 0.0);
+                    std::size_t i_max = std::min<std::size_t>(
+                        std::floor(u + du), neastings - 1
+                    );
+                    std::size_t j_max = std::min<std::size_t>(
+                        std::floor(v + dv), nnorthings - 1
+                    );
+                    // large scans are slower than the R-tree
+                    if((i_max - i_min + 1) * (j_max - j_min + 1) <= 
+                       max_lattice_scan) {
+                        for(std::size_t j1 = j_min; j1 <= j_max; ++j1) {
+                            for(std::size_t i1 = i_min; i1 <= i_max; ++i1) {
+                                Location * candidate = 
+                                    cell_location[i1 + neastings * j1];
+                                if(!candidate) {
+                                    continue;
+                                }
+                                double d = 
+                                    distance2(*candidate, easting, northing);
+                                if(d < d_min) {
+                                    d_min = d;
+                                    nearest = candidate;
+                                }
+                            }
+                        }
+                        return nearest;
+                    }
+                }
+            }
+            rtree_value res;
             domain_location_tree.query(
-                bgi::nearest(point(easting, northing), 1), 
-                std::back_inserter(res)
+                bgi::nearest(point(easting, northing), 1), &res
             );
-            return res[0].second;
+            return res.second;
+        }
+
+        /**
+         * Id of a location, i.e., its index in locations
+        */
+        std::size_t location_id(Location * location) const {
+            return location_ids.at(location);
+        }
+
+        /**
+         * States at a location, which is empty if no states belong to the 
+         * location
+        */
+        StateRange states_at(const Location * location) const {
+            auto id = location_ids.find(location);
+            if(id == location_ids.end()) {
+                return StateRange(nullptr, nullptr);
+            }
+            return states_at_id(id->second);
+        }
+
+        /**
+         * States at the location with a given id
+        */
+        StateRange states_at_id(std::size_t id) const {
+            return StateRange(
+                location_states.data() + state_offsets[id],
+                location_states.data() + state_offsets[id + 1]
+            );
+        }
+
+        /**
+         * Draw a state uniformly from the states at a location, or return 
+         * nullptr if no states belong to the location
+         *
+         * @param u uniform random variate in [0, 1)
+        */
+        StateType * sample_state_at(const Location * location, double u) const {
+            StateRange states = states_at(location);
+            if(states.empty()) {
+                return nullptr;
+            }
+            std::size_t i = static_cast<std::size_t>(u * states.size());
+            return states[std::min(i, states.size() - 1)];
+        }
+
+        /**
+         * Map coordinates to the ids of their closest locations, as in 
+         * map_location(), in parallel.  Coordinates that are not finite map 
+         * to n_locations().
+         *
+         * @param eastings,northings coordinates to map
+         * @param n number of coordinates
+         * @param ids output for n location ids
+         * @param nthreads number of threads to use
+        */
+        void map_location_ids(
+            const double * eastings, const double * northings, std::size_t n,
+            std::size_t * ids, std::size_t nthreads
+        ) const {
+            // map coordinates in blocks, which amortizes scheduling overhead
+            const std::size_t block_size = 1024;
+            std::size_t nblocks = (n + block_size - 1) / block_size;
+            auto map_block = [&](std::size_t b) {
+                std::size_t end = std::min(n, (b + 1) * block_size);
+                for(std::size_t i = b * block_size; i < end; ++i) {
+                    if(std::isfinite(eastings[i]) && 
+                       std::isfinite(northings[i])) {
+                        ids[i] = location_ids.at(
+                            map_location(eastings[i], northings[i])
+                        );
+                    } else {
+                        ids[i] = locations.size();
+                    }
+                }
+            };
+            WorkStealingPool pool(nthreads);
+            pool.run(std::vector<double>(nblocks, 1), map_block);
+        }
+
+        std::size_t n_locations() const { return locations.size(); }
+
+        /**
+         * Write the locations within the nsigma-contour of a bivariate 
+         * normal distribution, i.e., ProjectedLocationLikelihood, to an 
+         * output iterator.  The distribution must provide bounding_box() and 
+         * mahalanobis2().
+        */
+        template<typename Distribution, typename OutputIterator>
+        void map_ellipse(
+            const Distribution & distribution, double nsigma, 
+            OutputIterator out
+        ) const {
+            double min_easting, min_northing, max_easting, max_northing;
+            distribution.bounding_box(
+                nsigma, min_easting, min_northing, max_easting, max_northing
+            );
+            double nsigma2 = nsigma * nsigma;
+            auto value = domain_location_tree.qbegin(
+                bgi::intersects(
+                    bg::model::box<point>(
+                        point(min_easting, min_northing), 
+                        point(max_easting, max_northing)
+                    )
+                ) && 
+                bgi::satisfies([&](const rtree_value & v) {
+                    return distribution.mahalanobis2(
+                        v.second->easting, v.second->northing
+                    ) <= nsigma2;
+                })
+            );
+            auto value_end = domain_location_tree.qend();
+            for(; value != value_end; ++value) {
+                *(out++) = value->second;
+            }
+        }
+
+        /**
+         * Write the locations that lie within an axis-aligned box to 
+         * an output iterator
+        */
+        template<typename OutputIterator>
+        void map_box(
+            double min_easting, double min_northing, double max_easting, 
+            double max_northing, OutputIterator out
+        ) const {
+            auto value = domain_location_tree.qbegin(
+                bgi::intersects(
+                    bg::model::box<point>(
+                        point(min_easting, min_northing), 
+                        point(max_easting, max_northing)
+                    )
+                )
+            );
+            auto value_end = domain_location_tree.qend();
+            for(; value != value_end; ++value) {
+                *(out++) = value->second;
+            }
         }
 
 };
@@ -65,4 +531,25 @@ class StatespaceSearch {
 typedef StatespaceSearch<RookDirectionalStatespace> 
     RookDirectionalStatespaceSearch;
 
+/**
+ * Sample states from a Gaussian distribution constrained to a spatial domain,
+ * and with last movement directions uniformly sampled.  Must be called from 
+ * R's main thread.
+*/
+Rcpp::List sample_gaussian_states_from_hdop_uere(
+    Rcpp::XPtr<RookDirectionalStatespaceSearch> statespace_search, 
+    double easting, double northing, double hdop, double uere, std::size_t n
+);
+
+/**
+ * Sample states from a Gaussian distribution discretized over the locations 
+ * within its nsigma-contour, and with last movement directions uniformly 
+ * sampled.  Must be called from R's main thread.
+*/
+Rcpp::List sample_discretized_gaussian_states_from_hdop_uere(
+    Rcpp::XPtr<RookDirectionalStatespaceSearch> statespace_search, 
+    double easting, double northing, double hdop, double uere, std::size_t n,
+    double nsigma
+);
+
 #endif
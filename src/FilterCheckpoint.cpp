@@ -0,0 +1,325 @@
+#include "FilterCheckpoint.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+    // identifies checkpoint files and their format version
+    const char checkpoint_format[8] = {'M', 'V', 'C', 'K', 'P', 'T', '0', '2'};
+
+    template<typename T>
+    void write_value(std::ofstream & out, const T & x) {
+        out.write(reinterpret_cast<const char *>(&x), sizeof(T));
+    }
+
+    template<typename T>
+    T read_value(std::ifstream & in) {
+        T x;
+        in.read(reinterpret_cast<char *>(&x), sizeof(T));
+        return x;
+    }
+
+    // fold a value's bytes into an FNV-1a hash
+    template<typename T>
+    void hash_value(std::uint64_t & hash, const T & x) {
+        const unsigned char * bytes = 
+            reinterpret_cast<const unsigned char *>(&x);
+        for(std::size_t i = 0; i < sizeof(T); ++i) {
+            hash ^= bytes[i];
+            hash *= UINT64_C(0x100000001b3);
+        }
+    }
+
+}
+
+std::uint64_t CheckpointedFilter::hash_observations(
+    const std::vector<double> & eastings,
+    const std::vector<double> & northings,
+    const std::vector<double> & hdops, double uere,
+    const std::vector<std::size_t> & t, std::size_t nt
+) {
+    std::uint64_t hash = UINT64_C(0xcbf29ce484222325);
+    for(auto x : {&eastings, &northings, &hdops}) {
+        hash_value<std::uint64_t>(hash, x->size());
+        for(double v : *x) {
+            hash_value(hash, v);
+        }
+    }
+    hash_value(hash, uere);
+    hash_value<std::uint64_t>(hash, t.size());
+    for(std::size_t v : t) {
+        hash_value<std::uint64_t>(hash, v);
+    }
+    hash_value<std::uint64_t>(hash, nt);
+    return hash;
+}
+
+CheckpointedFilter::CheckpointedFilter(
+    Rcpp::XPtr<RookDirectionalStatespace> domain,
+    const std::vector<StateType*> & initial_states,
+    LikelihoodSeqType && likelihoods,
+    const Eigen::Ref<const Eigen::VectorXd> & theta, double delta,
+    const StreamRandom & stream, std::uint64_t observations
+) : statespace(domain), states(domain->states.size()),
+    likelihood_seq(std::move(likelihoods)),
+    proposal_seq(ConstantStepFamily<ParticleType>(likelihood_seq.size(), 1)),
+    parameters(theta.size() + 1), observation_hash(observations),
+    random_source(stream), table(*domain),
+    filter(std::vector<ParticleType>()) {
+
+    if(initial_states.empty()) {
+        Rcpp::stop("Argument initial_latent_state_sample must not be empty");
+    }
+    std::size_t ncovariates = 
+        initial_states.front()->properties.location->x.size();
+    if(static_cast<std::size_t>(theta.size()) != ncovariates + 1) {
+        Rcpp::stop("Argument beta has the wrong length");
+    }
+
+    for(auto & map_entry : statespace->states) {
+        states[map_entry.second.index] = &map_entry.second;
+    }
+
+    parameters.head(theta.size()) = theta;
+    parameters(theta.size()) = delta;
+    table.set_parameters(theta(0), theta.tail(ncovariates), delta);
+
+    // particles read transition distributions from the table and draw from 
+    // the filter's random number stream
+    std::vector<ParticleType> & particles = filter.initial_particles();
+    particles.reserve(initial_states.size());
+    ParticleType particle(table, table, random_source);
+    for(auto state : initial_states) {
+        particle.state = state;
+        particles.push_back(particle);
+    }
+
+    filter.proposal_distributions = &proposal_seq;
+    filter.likelihoods = &likelihood_seq;
+    filter.random_source = &random_source;
+    filter.initialize();
+}
+
+std::size_t CheckpointedFilter::run(std::size_t n) {
+    std::size_t nfiltered = 0;
+    while(!filter.finished() && (n == 0 || nfiltered < n)) {
+        filter.advance(observer);
+        ++nfiltered;
+    }
+    return nfiltered;
+}
+
+void CheckpointedFilter::save(const std::string & path) const {
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if(!out) {
+        Rcpp::stop("Unable to open file " + path);
+    }
+
+    // sizes and model parameters, to validate the file on resume
+    const std::vector<ParticleType> & particles = filter.particles();
+    out.write(checkpoint_format, sizeof(checkpoint_format));
+    write_value<std::uint64_t>(out, observation_hash);
+    write_value<std::uint64_t>(out, likelihood_seq.size());
+    write_value<std::uint64_t>(out, states.size());
+    write_value<std::uint64_t>(out, particles.size());
+    write_value<std::uint64_t>(out, parameters.size());
+    for(Eigen::Index i = 0; i < parameters.size(); ++i) {
+        write_value<double>(out, parameters(i));
+    }
+
+    // filter's progress
+    FilterType::Progress progress = filter.progress();
+    write_value<std::uint64_t>(out, progress.timepoint);
+    write_value<double>(out, progress.ll);
+    write_value<std::uint64_t>(out, progress.degenerate);
+    write_value<std::uint64_t>(out, progress.stopped);
+    write_value<double>(out, progress.ll_bound_total);
+    write_value<double>(out, progress.ll_bound_filtered);
+    write_value<std::uint64_t>(out, progress.nobs_total);
+    write_value<std::uint64_t>(out, progress.nobs_filtered);
+
+    // position of the random number stream
+    for(auto x : random_source.generator().state()) {
+        write_value<std::uint64_t>(out, x);
+    }
+
+    // particles' states and ancestors
+    for(auto & particle : particles) {
+        write_value<std::uint32_t>(out, particle.state->index);
+    }
+    const std::vector<std::size_t> & ancestors = filter.ancestors();
+    write_value<std::uint64_t>(out, ancestors.size());
+    for(auto ancestor : ancestors) {
+        write_value<std::uint32_t>(out, ancestor);
+    }
+
+    out.close();
+    if(out.fail()) {
+        Rcpp::stop("Unable to write file " + path);
+    }
+}
+
+void CheckpointedFilter::load(const std::string & path) {
+
+    std::ifstream in(path, std::ios::binary);
+    if(!in) {
+        Rcpp::stop("Unable to open file " + path);
+    }
+
+    char format[sizeof(checkpoint_format)];
+    in.read(format, sizeof(format));
+    if(!in || std::memcmp(format, checkpoint_format, sizeof(format)) != 0) {
+        Rcpp::stop("File " + path + " is not a filter checkpoint");
+    }
+
+    // the checkpoint must come from a filter for the same problem
+    std::size_t M = filter.initial_particles().size();
+    bool compatible = 
+        read_value<std::uint64_t>(in) == observation_hash &&
+        read_value<std::uint64_t>(in) == likelihood_seq.size() &&
+        read_value<std::uint64_t>(in) == states.size() &&
+        read_value<std::uint64_t>(in) == M &&
+        read_value<std::uint64_t>(in) == 
+            static_cast<std::uint64_t>(parameters.size());
+    for(Eigen::Index i = 0; compatible && i < parameters.size(); ++i) {
+        compatible = read_value<double>(in) == parameters(i);
+    }
+    if(!in || !compatible) {
+        Rcpp::stop("File " + path + " was saved by a filter for different "
+            "observations, particles, or model parameters");
+    }
+
+    FilterType::Progress progress;
+    progress.timepoint = read_value<std::uint64_t>(in);
+    progress.ll = read_value<double>(in);
+    progress.degenerate = read_value<std::uint64_t>(in);
+    progress.stopped = read_value<std::uint64_t>(in);
+    progress.ll_bound_total = read_value<double>(in);
+    progress.ll_bound_filtered = read_value<double>(in);
+    progress.nobs_total = read_value<std::uint64_t>(in);
+    progress.nobs_filtered = read_value<std::uint64_t>(in);
+
+    std::array<std::uint64_t, 4> rng_state;
+    for(auto & x : rng_state) {
+        x = read_value<std::uint64_t>(in);
+    }
+
+    std::vector<ParticleType> particles = filter.initial_particles();
+    for(auto & particle : particles) {
+        std::uint32_t id = read_value<std::uint32_t>(in);
+        if(id >= states.size()) {
+            Rcpp::stop("File " + path + " is corrupt");
+        }
+        particle.state = states[id];
+    }
+    std::vector<std::size_t> ancestors(read_value<std::uint64_t>(in));
+    if(ancestors.size() > M) {
+        Rcpp::stop("File " + path + " is corrupt");
+    }
+    for(auto & ancestor : ancestors) {
+        ancestor = read_value<std::uint32_t>(in);
+    }
+
+    if(!in || progress.timepoint > likelihood_seq.size()) {
+        Rcpp::stop("File " + path + " is corrupt");
+    }
+
+    random_source.generator().set_state(rng_state);
+    filter.resume(progress, particles, ancestors);
+}
+
+/**
+ * Build a particle filter for GPS observations that can save its progress to
+ * a file and resume from it, i.e., so runs on long tracks can survive 
+ * preemption or be split into time segments
+ *
+ * The filter draws from its own random number stream, seeded from R's 
+ * random number generator.  Filters built for the same observations, initial
+ * states, and model parameters that resume from a checkpoint reproduce an 
+ * uninterrupted run exactly when the package was built with the same C++ 
+ * standard library, since the resampling draws depend on the library's 
+ * binomial sampler.
+ *
+ * @param t vector of discrete time indices (starting at 0) at which
+ *   observations are available
+ * @param nt total number of discrete timepoints
+ * @param statespace Object constructed from \code{build_statespace}
+ * @param initial_latent_state_sample Sample of states, i.e., from
+ *   \code{sample_gaussian_states_from_hdop_uere}
+*/
+// [[Rcpp::export]]
+Rcpp::XPtr<CheckpointedFilter> build_checkpointed_filter_from_gps(
+    /* likelihood components */
+    std::vector<double> eastings, std::vector<double> northings,
+    std::vector<double> hdops, double uere, std::vector<std::size_t> t,
+    std::size_t nt,
+    /* filter components */
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::XPtr<
+        std::vector<RookDirectionalStatespace::StateType*>
+    > initial_latent_state_sample,
+    /* model parameters */
+    double directional_persistence, Eigen::VectorXd beta, double delta
+) {
+    Eigen::VectorXd theta(beta.size() + 1);
+    theta(0) = directional_persistence;
+    theta.tail(beta.size()) = beta;
+    CheckpointedFilter * filter = new CheckpointedFilter(
+        statespace, *initial_latent_state_sample,
+        AppliedLikelihoodFamilyFromGPS(
+            eastings, northings, hdops, uere, t, nt
+        ),
+        theta, delta, StreamRandom::from_r(),
+        CheckpointedFilter::hash_observations(
+            eastings, northings, hdops, uere, t, nt
+        )
+    );
+    return Rcpp::XPtr<CheckpointedFilter>(filter, true);
+}
+
+/**
+ * Filter more timepoints with a filter built by 
+ * \code{build_checkpointed_filter_from_gps}
+ *
+ * @param ntimepoints maximum number of timepoints to filter, or 0 to filter 
+ *   all remaining timepoints
+ * @param checkpoint file to save the filter's progress to afterwards, or an
+ *   empty string to skip saving
+ * @return list with the log-likelihood for the timepoints filtered so far, 
+ *   the number of timepoints filtered so far, and whether the filter has
+ *   finished
+*/
+// [[Rcpp::export]]
+Rcpp::List checkpointed_filter_run(
+    Rcpp::XPtr<CheckpointedFilter> filter, std::size_t ntimepoints = 0,
+    std::string checkpoint = ""
+) {
+    filter->run(ntimepoints);
+    if(!checkpoint.empty()) {
+        filter->save(checkpoint);
+    }
+    return Rcpp::List::create(
+        Rcpp::Named("ll") = filter->loglik(),
+        Rcpp::Named("timepoints") = filter->size(),
+        Rcpp::Named("finished") = filter->finished()
+    );
+}
+
+/**
+ * Restore a filter built by \code{build_checkpointed_filter_from_gps} from a
+ * checkpoint saved via \code{checkpointed_filter_run}.  The filter must be 
+ * built for the same observations, number of particles, and model parameters
+ * as the filter that saved the checkpoint.
+ *
+ * @param checkpoint file to resume from
+ * @return number of timepoints filtered before the checkpoint was saved
+*/
+// [[Rcpp::export]]
+std::size_t checkpointed_filter_resume(
+    Rcpp::XPtr<CheckpointedFilter> filter, std::string checkpoint
+) {
+    filter->load(checkpoint);
+    return filter->size();
+}
@@ -0,0 +1,154 @@
+/**
+ * Particle filters that save their progress to checkpoint files and resume
+ * from them, i.e., for long tracks on machines that may preempt jobs
+*/
+
+#ifndef MOVECON_FILTER_CHECKPOINT_H
+#define MOVECON_FILTER_CHECKPOINT_H
+
+// [[Rcpp::depends(RcppEigen)]]
+
+#include <RcppEigen.h>
+
+#include "Domain.h"
+#include "Directions.h"
+#include "AppliedLikelihood.h"
+#include "ParticleFilter.h"
+#include "TransitionTable.h"
+#include "Random.h"
+
+/**
+ * Particle filter that can save its state to a file part way through a track
+ * and resume from the file later, i.e., so long runs can survive preemption
+ * or be split into segments.
+ *
+ * The filter draws from its own random number stream, so a checkpoint holds
+ * everything needed to continue: the particles' state ids, their ancestors,
+ * the filter's progress, and the stream's position.  A filter built for the
+ * same observations, initial states, and model parameters that resumes from
+ * a checkpoint reproduces an uninterrupted run exactly, provided both runs
+ * are built against the same C++ standard library.  Resampling counts come
+ * from std::binomial_distribution, whose algorithm the standard leaves to the
+ * implementation, so the same stream position can yield different counts
+ * under another standard library.
+ *
+ * Checkpoint files begin with a format identifier, followed by a hash of the
+ * observations and the sizes and model parameters the filter was built with,
+ * which are checked on resume, and then the filter's state.  Values use the
+ * machine's native byte order.
+*/
+class CheckpointedFilter {
+
+    public:
+
+        typedef RookDirectionalStatespace::StateType StateType;
+
+        typedef LazyTransitionTable<CardinalDirectionOrientations>
+            TransitionTableType;
+
+        typedef Particle<
+            StateType,
+            TransitionTableType,
+            TransitionTableType,
+            StreamRandom
+        > ParticleType;
+
+        typedef std::vector<std::unique_ptr<AppliedLikelihood>>
+            LikelihoodSeqType;
+        typedef std::vector<NStepProposal<ParticleType>> ProposalSeqType;
+
+        typedef BootstrapParticleFilter<
+            ParticleType,
+            ProposalSeqType,
+            LikelihoodSeqType,
+            NullObserver<ParticleType>,
+            StreamRandom
+        > FilterType;
+
+    private:
+
+        Rcpp::XPtr<RookDirectionalStatespace> statespace;
+
+        // statespace's states, by state index
+        std::vector<StateType*> states;
+
+        LikelihoodSeqType likelihood_seq;
+        ProposalSeqType proposal_seq;
+
+        // model parameters, i.e., (directional_persistence, beta, delta)
+        Eigen::VectorXd parameters;
+
+        // hash of the observations the likelihoods were built from
+        std::uint64_t observation_hash;
+
+        StreamRandom random_source;
+
+        TransitionTableType table;
+
+        FilterType filter;
+
+        NullObserver<ParticleType> observer;
+
+    public:
+
+        /**
+         * @param domain statespace the initial states belong to
+         * @param initial_states initial latent states, one for each particle
+         * @param likelihoods one likelihood for each discrete timepoint
+         * @param theta model parameters, i.e., (directional_persistence,
+         *   beta)
+         * @param delta uniformization constant for transition rates
+         * @param stream random numbers for the filter
+         * @param observations hash of the observations the likelihoods were
+         *   built from, i.e., from hash_observations()
+        */
+        CheckpointedFilter(
+            Rcpp::XPtr<RookDirectionalStatespace> domain,
+            const std::vector<StateType*> & initial_states,
+            LikelihoodSeqType && likelihoods,
+            const Eigen::Ref<const Eigen::VectorXd> & theta, double delta,
+            const StreamRandom & stream, std::uint64_t observations
+        );
+
+        /**
+         * FNV-1a hash of GPS observations, i.e., to check that a checkpoint
+         * was saved by a filter for the same observations
+        */
+        static std::uint64_t hash_observations(
+            const std::vector<double> & eastings,
+            const std::vector<double> & northings,
+            const std::vector<double> & hdops, double uere,
+            const std::vector<std::size_t> & t, std::size_t nt
+        );
+
+        CheckpointedFilter(const CheckpointedFilter &) = delete;
+        CheckpointedFilter & operator=(const CheckpointedFilter &) = delete;
+
+        /**
+         * Filter up to n more timepoints, or all remaining timepoints if n is
+         * 0.  Returns the number of timepoints filtered.
+        */
+        std::size_t run(std::size_t n);
+
+        /**
+         * Write the filter's state to a file
+        */
+        void save(const std::string & path) const;
+
+        /**
+         * Restore the filter's state from a file written by save() for a
+         * filter with the same observations and model parameters
+        */
+        void load(const std::string & path);
+
+        std::size_t size() const { return filter.size(); }
+
+        std::size_t ntimepoints() const { return likelihood_seq.size(); }
+
+        double loglik() const { return filter.loglik(); }
+
+        bool finished() const { return filter.finished(); }
+
+};
+
+#endif
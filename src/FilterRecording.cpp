@@ -0,0 +1,74 @@
+#include "FilterRecording.h"
+
+OccupancyGrid::OccupancyGrid(const RookDirectionalStatespace & statespace) :
+    neastings(statespace.neastings), nnorthings(statespace.nnorthings) {
+
+    // coordinates along each grid axis
+    eastings.assign(neastings, NA_REAL);
+    northings.assign(nnorthings, NA_REAL);
+    for(auto & map_entry : statespace.grid) {
+        eastings[map_entry.first.first] = map_entry.second.easting;
+        northings[map_entry.first.second] = map_entry.second.northing;
+    }
+
+    // associate states with grid cells
+    state_cells.resize(statespace.states.size());
+    for(auto & map_entry : statespace.states) {
+        std::size_t easting_ind = std::get<1>(map_entry.first);
+        std::size_t northing_ind = std::get<2>(map_entry.first);
+        state_cells[map_entry.second.index] = 
+            easting_ind + neastings * northing_ind;
+    }
+}
+
+/**
+ * Load filtering distributions that were streamed to a binary file as state 
+ * ids, i.e., by \code{Particle_Filter_State_Ids_To_File_From_GPS}
+ * 
+ * @param path file to read
+ * @return list with the 0-based timepoints that were recorded, and a matrix 
+ *   of state ids with one column for each recorded timepoint
+*/
+// [[Rcpp::export]]
+Rcpp::List read_state_id_file(std::string path) {
+
+    std::ifstream in(path, std::ios::binary);
+    if(!in) {
+        Rcpp::stop("Unable to open file " + path);
+    }
+
+    std::vector<double> timepoints;
+    std::vector<std::uint32_t> state_ids;
+    std::size_t M = 0;
+
+    // read records until the end of the file
+    std::uint64_t header[2];
+    while(in.read(reinterpret_cast<char *>(header), sizeof(header))) {
+        if(timepoints.empty()) {
+            M = header[1];
+        } else if(header[1] != M) {
+            Rcpp::stop("Records in file " + path + " have different sizes");
+        }
+        std::size_t offset = state_ids.size();
+        state_ids.resize(offset + M);
+        in.read(
+            reinterpret_cast<char *>(state_ids.data() + offset),
+            M * sizeof(std::uint32_t)
+        );
+        if(!in) {
+            Rcpp::stop("File " + path + " ends with an incomplete record");
+        }
+        timepoints.push_back(header[0]);
+    }
+    if(in.gcount() != 0) {
+        Rcpp::stop("File " + path + " ends with an incomplete record");
+    }
+
+    Rcpp::IntegerMatrix ids(M, timepoints.size());
+    std::copy(state_ids.begin(), state_ids.end(), ids.begin());
+
+    return Rcpp::List::create(
+        Rcpp::Named("timepoints") = timepoints,
+        Rcpp::Named("state_ids") = ids
+    );
+}
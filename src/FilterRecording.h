@@ -0,0 +1,257 @@
+/**
+ * Observers that record filtering distributions compactly, i.e., for long
+ * deployments in which storing every particle at every timepoint would
+ * exhaust memory
+*/
+
+#ifndef MOVECON_FILTER_RECORDING_H
+#define MOVECON_FILTER_RECORDING_H
+
+#include <Rcpp.h>
+
+#include "Domain.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * Timepoints at which observers record filtering distributions, either every
+ * stride'th timepoint starting at 0, or a list of timepoints in increasing
+ * order, i.e., the observation times.  Timepoints must be queried in
+ * increasing order.
+*/
+class RecordingSchedule {
+
+    private:
+
+        std::size_t stride;
+        std::vector<std::size_t> times;
+        std::vector<std::size_t>::const_iterator next;
+
+    public:
+
+        /**
+         * Record every stride'th timepoint
+        */
+        explicit RecordingSchedule(std::size_t every = 1) :
+            stride(every), next(times.end()) { }
+
+        /**
+         * Record the listed timepoints, which must be in increasing order
+        */
+        explicit RecordingSchedule(const std::vector<std::size_t> & t) :
+            stride(0), times(t), next(times.begin()) { }
+
+        RecordingSchedule(const RecordingSchedule & rhs) :
+            stride(rhs.stride), times(rhs.times),
+            next(times.begin() + (rhs.next - rhs.times.begin())) { }
+
+        /**
+         * Start again from timepoint 0
+        */
+        void reset() {
+            next = times.begin();
+        }
+
+        bool includes(std::size_t t) {
+            if(stride > 0) {
+                return t % stride == 0;
+            }
+            while(next != times.end() && *next < t) {
+                ++next;
+            }
+            return next != times.end() && *next == t;
+        }
+
+};
+
+/**
+ * Record the filtering distributions at scheduled timepoints as compact state
+ * ids, i.e., State::index, which costs 4 bytes per particle at each recorded
+ * timepoint.
+*/
+template<typename Particle>
+struct StateIdObserver {
+
+    RecordingSchedule schedule;
+
+    // state ids for each recorded timepoint, stored contiguously
+    std::vector<std::uint32_t> state_ids;
+
+    // recorded timepoints, and the number of particles at each
+    std::vector<std::size_t> timepoints;
+    std::vector<std::size_t> sizes;
+
+    // number of filtering distributions observed so far
+    std::size_t timepoint = 0;
+
+    explicit StateIdObserver(const RecordingSchedule & s) : schedule(s) { }
+
+    void operator()(const std::vector<Particle> & particles, double ll) {
+        if(schedule.includes(timepoint)) {
+            timepoints.push_back(timepoint);
+            sizes.push_back(particles.size());
+            for(auto & particle : particles) {
+                state_ids.push_back(
+                    static_cast<std::uint32_t>(particle.state->index)
+                );
+            }
+        }
+        ++timepoint;
+    }
+
+};
+
+/**
+ * Stream the filtering distributions at scheduled timepoints to a binary file
+ * as compact state ids, so memory use does not grow with the length of the
+ * track.
+ *
+ * Files contain one record for each recorded timepoint, which consists of the
+ * timepoint and the number of particles M as 64-bit unsigned integers,
+ * followed by M 32-bit unsigned state ids, i.e., State::index.  Values use
+ * the machine's native byte order.
+*/
+template<typename Particle>
+class StateIdFileObserver {
+
+    private:
+
+        RecordingSchedule schedule;
+
+        std::ofstream out;
+
+        // scratch space for a record's state ids
+        std::vector<std::uint32_t> state_ids;
+
+        std::size_t timepoint;
+
+        std::size_t nrecorded;
+
+    public:
+
+        StateIdFileObserver(
+            const std::string & path, const RecordingSchedule & s
+        ) : schedule(s), out(path, std::ios::binary | std::ios::trunc),
+            timepoint(0), nrecorded(0) { }
+
+        void operator()(const std::vector<Particle> & particles, double ll) {
+            if(schedule.includes(timepoint) && out) {
+                std::uint64_t header[2] = { timepoint, particles.size() };
+                state_ids.clear();
+                for(auto & particle : particles) {
+                    state_ids.push_back(
+                        static_cast<std::uint32_t>(particle.state->index)
+                    );
+                }
+                out.write(reinterpret_cast<const char *>(header),
+                    sizeof(header));
+                out.write(
+                    reinterpret_cast<const char *>(state_ids.data()),
+                    state_ids.size() * sizeof(std::uint32_t)
+                );
+                ++nrecorded;
+            }
+            ++timepoint;
+        }
+
+        /**
+         * Flush buffered records, returning false if any write failed
+        */
+        bool close() {
+            out.close();
+            return !out.fail();
+        }
+
+        bool good() const { return out.good(); }
+
+        std::size_t size() const { return nrecorded; }
+
+};
+
+/**
+ * Raster layout for a statespace's grid, which associates each state with the 
+ * grid cell for its location.  Cells are numbered in column-major order with 
+ * eastings as the inner loop, i.e., cell i + neastings * j contains the 
+ * location with easting index i and northing index j.
+*/
+struct OccupancyGrid {
+
+    std::size_t neastings, nnorthings;
+
+    // coordinates along each grid axis, or NA for indices without locations
+    std::vector<double> eastings, northings;
+
+    // grid cell for each state, by state index
+    std::vector<std::size_t> state_cells;
+
+    explicit OccupancyGrid(const RookDirectionalStatespace & statespace);
+
+    std::size_t size() const { return neastings * nnorthings; }
+
+};
+
+/**
+ * Count the particles in each grid cell at scheduled timepoints, i.e., to 
+ * build spatial histograms of the filtering distributions without storing 
+ * them.  Counts may be split into consecutive time windows, in which case 
+ * window w counts the scheduled timepoints t for which t / window_length = w.
+*/
+template<typename Particle>
+class OccupancyObserver {
+
+    private:
+
+        RecordingSchedule schedule;
+
+        const OccupancyGrid & grid;
+
+        // number of timepoints per window, or 0 for a single window
+        std::size_t window_length;
+
+        std::size_t timepoint;
+
+    public:
+
+        // particle counts, with one column of grid cells for each window
+        std::vector<double> counts;
+
+        // number of filtering distributions counted in each window
+        std::vector<std::size_t> ndistributions;
+
+        /**
+         * @param cells raster layout for the filter's statespace
+         * @param nt total number of discrete timepoints
+         * @param length number of timepoints per window, or 0 to count all 
+         *   timepoints in a single window
+         * @param s timepoints at which to count particles
+        */
+        OccupancyObserver(
+            const OccupancyGrid & cells, std::size_t nt, std::size_t length,
+            const RecordingSchedule & s
+        ) : schedule(s), grid(cells), window_length(length), timepoint(0) {
+            std::size_t nwindows = window_length == 0 ? 1 :
+                (nt + window_length - 1) / window_length;
+            counts.assign(grid.size() * std::max<std::size_t>(nwindows, 1), 0);
+            ndistributions.assign(std::max<std::size_t>(nwindows, 1), 0);
+        }
+
+        std::size_t nwindows() const { return ndistributions.size(); }
+
+        void operator()(const std::vector<Particle> & particles, double ll) {
+            std::size_t w = window_length == 0 ? 0 : timepoint / window_length;
+            if(schedule.includes(timepoint) && w < nwindows()) {
+                double * window_counts = counts.data() + w * grid.size();
+                for(auto & particle : particles) {
+                    ++window_counts[grid.state_cells[particle.state->index]];
+                }
+                ++ndistributions[w];
+            }
+            ++timepoint;
+        }
+
+};
+
+#endif
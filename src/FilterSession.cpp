@@ -0,0 +1,129 @@
+#include "FilterSession.h"
+
+FilterSession::FilterSession(
+    Rcpp::XPtr<RookDirectionalStatespace> domain,
+    const std::vector<StateType*> & states,
+    LikelihoodSeqType && likelihoods
+) : statespace(domain), initial_states(states),
+    likelihood_seq(std::move(likelihoods)),
+    proposal_seq(ConstantStepFamily<ParticleType>(likelihood_seq.size(), 1)),
+    filter(std::vector<ParticleType>()) {
+
+    if(initial_states.empty()) {
+        Rcpp::stop("Argument initial_latent_state_sample must not be empty");
+    }
+
+    // size the parameter storage to match the covariates
+    beta.resize(initial_states.front()->properties.location->x.size());
+
+    filter.proposal_distributions = &proposal_seq;
+    filter.likelihoods = &likelihood_seq;
+    filter.initial_particles().reserve(initial_states.size());
+}
+
+double FilterSession::loglik(
+    double directional_persistence,
+    const Eigen::Ref<const Eigen::VectorXd> & new_beta,
+    double delta, double threshold, double margin
+) {
+
+    if(new_beta.size() != beta.size()) {
+        Rcpp::stop("Argument beta has the wrong length");
+    }
+    beta = new_beta;
+
+    // reset cached state values
+    statespace->reset_transition_cache();
+
+    // construct transition rate evaluator
+    base_transition_rate location_based_rate(beta);
+    uniformized_transition_rate uniformized_rate(&location_based_rate, delta);
+    particle_transition_rate transition_rate(uniformized_rate);
+
+    // construct transition probability evaluator
+    directional_probabilities directional_probs(directional_persistence);
+    particle_transition_probability transition_prob(directional_probs);
+
+    // rebuild particles for the initial states in the filter's storage
+    std::vector<ParticleType> & particles = filter.initial_particles();
+    particles.clear();
+    ParticleType particle(transition_rate, transition_prob);
+    for(auto state : initial_states) {
+        particle.state = state;
+        particles.push_back(particle);
+    }
+
+    filter.termination_threshold = threshold;
+    filter.termination_margin = margin;
+
+    return filter.marginal_ll();
+}
+
+/**
+ * Build a persistent particle filter for GPS observations that can be used to
+ * repeatedly evaluate the likelihood for new model parameters
+ *
+ * @param t vector of discrete time indices (starting at 0) at which
+ *   observations are available
+ * @param nt total number of discrete timepoints
+ * @param statespace Object constructed from \code{build_statespace}
+ * @param initial_latent_state_sample Sample of states, i.e., from
+ *   \code{sample_gaussian_states_from_hdop_uere}
+*/
+// [[Rcpp::export]]
+Rcpp::XPtr<FilterSession> build_filter_session_from_gps(
+    /* likelihood components */
+    std::vector<double> eastings, std::vector<double> northings,
+    std::vector<double> hdops, double uere, std::vector<std::size_t> t,
+    std::size_t nt,
+    /* filter components */
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::XPtr<
+        std::vector<RookDirectionalStatespace::StateType*>
+    > initial_latent_state_sample
+) {
+    FilterSession * session = new FilterSession(
+        statespace, *initial_latent_state_sample,
+        AppliedLikelihoodFamilyFromGPS(
+            eastings, northings, hdops, uere, t, nt
+        )
+    );
+    return Rcpp::XPtr<FilterSession>(session, true);
+}
+
+/**
+ * Particle filter approximation to the marginal log-likelihood using a
+ * persistent filter built by \code{build_filter_session_from_gps}
+ *
+ * @param threshold stop the filter early once its log-likelihood is certain 
+ *   to end below threshold, i.e., the current log-likelihood plus the log of
+ *   the acceptance uniform minus the log-prior difference in an MH sampler.
+ *   The returned value then only includes the observations filtered before 
+ *   the filter stopped, which \code{filter_session_truncated} reports.
+ * @param margin if finite, also stop the filter once a projection of its 
+ *   final log-likelihood falls more than margin below threshold.  This 
+ *   approximate mode saves more work but sometimes stops for proposals that 
+ *   would have been accepted, biasing MH samplers; larger margins reduce the
+ *   bias and the savings.
+*/
+// [[Rcpp::export]]
+double filter_session_loglik(
+    Rcpp::XPtr<FilterSession> session,
+    /* model parameters */
+    double directional_persistence, Rcpp::NumericVector beta, double delta,
+    double threshold = R_NegInf, double margin = R_PosInf
+) {
+    return session->loglik(
+        directional_persistence,
+        Eigen::Map<Eigen::VectorXd>(beta.begin(), beta.size()),
+        delta, threshold, margin
+    );
+}
+
+/**
+ * true if the most recent call to \code{filter_session_loglik} stopped early
+*/
+// [[Rcpp::export]]
+bool filter_session_truncated(Rcpp::XPtr<FilterSession> session) {
+    return session->truncated();
+}
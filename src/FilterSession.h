@@ -0,0 +1,100 @@
+#ifndef MOVECON_FILTER_SESSION_H
+#define MOVECON_FILTER_SESSION_H
+
+// [[Rcpp::depends(RcppEigen)]]
+
+#include <RcppEigen.h>
+
+#include "Domain.h"
+#include "AppliedLikelihood.h"
+#include "ParticleFilter.h"
+
+/**
+ * Persistent particle filter for a fixed set of observations and initial
+ * latent states.
+ *
+ * The observation model, proposal distributions, particles, and filter buffers
+ * are built once so that the likelihood can be re-evaluated for new model
+ * parameters without re-allocating memory, i.e., within MCMC samplers that
+ * repeatedly evaluate the likelihood for the same data.
+*/
+class FilterSession {
+
+    public:
+
+        typedef RookDirectionalStatespace::StateType StateType;
+
+        typedef AppliedLikelihood::base_transition_rate base_transition_rate;
+        typedef AppliedLikelihood::uniformized_transition_rate
+            uniformized_transition_rate;
+        typedef AppliedLikelihood::particle_transition_rate
+            particle_transition_rate;
+        typedef AppliedLikelihood::directional_probabilities
+            directional_probabilities;
+        typedef AppliedLikelihood::particle_transition_probability
+            particle_transition_probability;
+
+        typedef AppliedLikelihood::ParticleType ParticleType;
+
+        typedef std::vector<std::unique_ptr<AppliedLikelihood>>
+            LikelihoodSeqType;
+        typedef std::vector<NStepProposal<ParticleType>> ProposalSeqType;
+
+        typedef BootstrapParticleFilter<
+            ParticleType, ProposalSeqType, LikelihoodSeqType
+        > FilterType;
+
+    private:
+
+        Rcpp::XPtr<RookDirectionalStatespace> statespace;
+
+        std::vector<StateType*> initial_states;
+
+        LikelihoodSeqType likelihood_seq;
+        ProposalSeqType proposal_seq;
+
+        // storage for the most recent location-based movement parameters
+        Eigen::VectorXd beta;
+
+        FilterType filter;
+
+    public:
+
+        /**
+         * @param domain statespace the initial states belong to
+         * @param states initial latent states, one for each particle
+         * @param likelihoods one likelihood for each discrete timepoint
+        */
+        FilterSession(
+            Rcpp::XPtr<RookDirectionalStatespace> domain,
+            const std::vector<StateType*> & states,
+            LikelihoodSeqType && likelihoods
+        );
+
+        FilterSession(const FilterSession &) = delete;
+        FilterSession & operator=(const FilterSession &) = delete;
+
+        /**
+         * Particle filter approximation to the marginal log-likelihood
+         *
+         * @param threshold the filter stops early if its log-likelihood will
+         *   fall below threshold (see 
+         *   BootstrapParticleFilter::termination_threshold)
+         * @param margin margin for approximate early termination (see 
+         *   BootstrapParticleFilter::termination_margin)
+        */
+        double loglik(
+            double directional_persistence,
+            const Eigen::Ref<const Eigen::VectorXd> & new_beta,
+            double delta, double threshold = R_NegInf, 
+            double margin = R_PosInf
+        );
+
+        /**
+         * true if the most recent likelihood evaluation stopped early
+        */
+        bool truncated() const { return filter.truncated(); }
+
+};
+
+#endif
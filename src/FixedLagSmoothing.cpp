@@ -0,0 +1,205 @@
+#include "FixedLagSmoothing.h"
+
+FixedLagSmoother::FixedLagSmoother(
+    Rcpp::XPtr<RookDirectionalStatespace> domain,
+    const std::vector<StateType*> & states, std::size_t smoothing_lag,
+    double directional_persistence,
+    const Eigen::Ref<const Eigen::VectorXd> & beta_init, double delta,
+    double gps_uere
+) : statespace(domain), beta(beta_init), location_based_rate(beta),
+    uniformized_rate(&location_based_rate, delta),
+    transition_rate(uniformized_rate),
+    directional_probs(directional_persistence),
+    transition_prob(directional_probs), uere(gps_uere), step_proposal(1),
+    filter(std::vector<ParticleType>()), lag(smoothing_lag),
+    history_states(smoothing_lag + 1), history_ancestors(smoothing_lag + 1) {
+
+    if(states.empty()) {
+        Rcpp::stop("Argument initial_latent_state_sample must not be empty");
+    }
+    if(static_cast<std::size_t>(beta.size()) != static_cast<std::size_t>(
+       states.front()->properties.location->x.size())) {
+        Rcpp::stop("Argument beta has the wrong length");
+    }
+
+    // reset cached state values
+    statespace->reset_transition_cache();
+
+    // build particles for the initial states in the filter's storage
+    std::vector<ParticleType> & particles = filter.initial_particles();
+    particles.reserve(states.size());
+    ParticleType particle(transition_rate, transition_prob);
+    for(auto state : states) {
+        particle.state = state;
+        particles.push_back(particle);
+    }
+
+    // size the history's storage once
+    for(std::size_t i = 0; i <= lag; ++i) {
+        history_states[i].reserve(states.size());
+        history_ancestors[i].reserve(states.size());
+    }
+    lineage.reserve(states.size());
+
+    filter.initialize();
+}
+
+double FixedLagSmoother::advance(AppliedLikelihood & likelihood) {
+
+    double ll_t = filter.advance(step_proposal, likelihood, observer);
+    if(filter.finished()) {
+        return ll_t;
+    }
+
+    // record the filtering distribution in the ring buffer
+    std::size_t slot = (filter.size() - 1) % (lag + 1);
+    std::vector<StateType*> & slot_states = history_states[slot];
+    slot_states.clear();
+    for(auto & particle : filter.particles()) {
+        slot_states.push_back(particle.state);
+    }
+    history_ancestors[slot] = filter.ancestors();
+
+    return ll_t;
+}
+
+double FixedLagSmoother::append_observation(
+    double easting, double northing, double hdop, std::size_t nsteps
+) {
+
+    if(nsteps == 0) {
+        Rcpp::stop("Argument nsteps must be positive");
+    }
+    if(filter.finished()) {
+        return R_NegInf;
+    }
+
+    // timepoints without observations
+    for(std::size_t i = 1; i < nsteps; ++i) {
+        advance(flat_likelihood);
+    }
+
+    AppliedLocationLikelihood likelihood = 
+        AppliedLocationLikelihood::from_hdop_uere(
+            easting, northing, hdop, uere
+        );
+    return advance(likelihood);
+}
+
+std::vector<FixedLagSmoother::StateType*> FixedLagSmoother::smoothed_at(
+    std::size_t t
+) {
+
+    std::size_t nt = filter.size();
+    if(t >= nt || nt - 1 - t > lag) {
+        Rcpp::stop("Timepoint t must be within lag timepoints of the most "
+            "recent timepoint");
+    }
+
+    // trace the current particles' ancestors back to timepoint t
+    std::size_t M = history_states[(nt - 1) % (lag + 1)].size();
+    lineage.resize(M);
+    for(std::size_t i = 0; i < M; ++i) {
+        lineage[i] = i;
+    }
+    for(std::size_t s = nt - 1; s > t; --s) {
+        const std::vector<std::size_t> & ancestors = 
+            history_ancestors[s % (lag + 1)];
+        for(auto & ind : lineage) {
+            ind = ancestors[ind];
+        }
+    }
+
+    const std::vector<StateType*> & states = history_states[t % (lag + 1)];
+    std::vector<StateType*> smoothed(M);
+    for(std::size_t i = 0; i < M; ++i) {
+        smoothed[i] = states[lineage[i]];
+    }
+    return smoothed;
+}
+
+/**
+ * Build a particle filter for GPS observations that arrive one at a time, 
+ * i.e., from live collar feeds, which also provides fixed-lag smoothed 
+ * estimates
+ *
+ * @param statespace Object constructed from \code{build_statespace}
+ * @param initial_latent_state_sample Sample of states, i.e., from
+ *   \code{sample_gaussian_states_from_hdop_uere}
+ * @param lag number of discrete timepoints to smooth over, i.e., smoothed 
+ *   estimates for a timepoint are available until lag more timepoints are
+ *   filtered
+ * @param uere user equivalent range error for the GPS observations
+*/
+// [[Rcpp::export]]
+Rcpp::XPtr<FixedLagSmoother> build_fixed_lag_smoother(
+    /* filter components */
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::XPtr<
+        std::vector<RookDirectionalStatespace::StateType*>
+    > initial_latent_state_sample,
+    std::size_t lag,
+    /* model parameters */
+    double directional_persistence, Rcpp::NumericVector beta, double delta,
+    /* likelihood components */
+    double uere
+) {
+    FixedLagSmoother * smoother = new FixedLagSmoother(
+        statespace, *initial_latent_state_sample, lag, directional_persistence,
+        Eigen::Map<Eigen::VectorXd>(beta.begin(), beta.size()), delta, uere
+    );
+    return Rcpp::XPtr<FixedLagSmoother>(smoother, true);
+}
+
+/**
+ * Filter a GPS observation with a smoother built by
+ * \code{build_fixed_lag_smoother}
+ *
+ * @param nsteps number of discrete timepoints since the previous observation,
+ *   or the 1-based timepoint for the first observation
+ * @return running approximation to the marginal log-likelihood for all 
+ *   observations filtered so far, which is -Inf if the filter degenerated
+*/
+// [[Rcpp::export]]
+double fixed_lag_smoother_append_observation(
+    Rcpp::XPtr<FixedLagSmoother> smoother, double easting, double northing,
+    double hdop, std::size_t nsteps = 1
+) {
+    smoother->append_observation(easting, northing, hdop, nsteps);
+    return smoother->loglik();
+}
+
+/**
+ * Fixed-lag smoothed distribution from a smoother built by 
+ * \code{build_fixed_lag_smoother}
+ *
+ * @param t 0-based timepoint, which must be within lag timepoints of the most
+ *   recently filtered timepoint, i.e., at least \code{nt - 1 - lag} after
+ *   filtering nt timepoints
+ * @return list with the mean easting and northing of the smoothed 
+ *   distribution, and the particles' state ids, i.e., see 
+ *   \code{statespace_state_locations}
+*/
+// [[Rcpp::export]]
+Rcpp::List fixed_lag_smoother_smoothed_at(
+    Rcpp::XPtr<FixedLagSmoother> smoother, std::size_t t
+) {
+
+    std::vector<RookDirectionalStatespace::StateType*> states = 
+        smoother->smoothed_at(t);
+
+    double easting = 0;
+    double northing = 0;
+    Rcpp::IntegerVector state_ids(states.size());
+    for(std::size_t i = 0; i < states.size(); ++i) {
+        easting += states[i]->properties.location->easting;
+        northing += states[i]->properties.location->northing;
+        state_ids[i] = states[i]->index;
+    }
+
+    return Rcpp::List::create(
+        Rcpp::Named("easting") = easting / states.size(),
+        Rcpp::Named("northing") = northing / states.size(),
+        Rcpp::Named("state_ids") = state_ids
+    );
+}
@@ -0,0 +1,147 @@
+/**
+ * Online particle filtering with fixed-lag smoothing, i.e., for GPS
+ * observations that arrive live rather than as a complete track
+*/
+
+#ifndef MOVECON_FIXED_LAG_SMOOTHING_H
+#define MOVECON_FIXED_LAG_SMOOTHING_H
+
+// [[Rcpp::depends(RcppEigen)]]
+
+#include <RcppEigen.h>
+
+#include "Domain.h"
+#include "AppliedLikelihood.h"
+#include "ParticleFilter.h"
+
+/**
+ * Particle filter for observations that arrive one at a time, i.e., from live
+ * GPS collar feeds, which also provides fixed-lag smoothed estimates
+ * (Kitagawa and Sato, 2001, doi: 10.1007/978-1-4757-3437-9_9).
+ *
+ * Each new observation advances the filter without revisiting earlier
+ * observations.  The states and ancestors of the particles in the most recent
+ * lag + 1 filtering distributions are kept in a ring buffer, so the smoothed
+ * distribution for a timepoint within the lag can be found by tracing the
+ * current particles' ancestors back to the timepoint.  Memory and work per
+ * observation depend on the lag and number of particles, but not on the
+ * length of the track.
+ *
+ * Particles read transition rates and probabilities from the statespace's
+ * cache, which is reset when the smoother is built, so the statespace must
+ * not be used with other model parameters while observations are appended.
+*/
+class FixedLagSmoother {
+
+    public:
+
+        typedef RookDirectionalStatespace::StateType StateType;
+
+        typedef AppliedLikelihood::base_transition_rate base_transition_rate;
+        typedef AppliedLikelihood::uniformized_transition_rate
+            uniformized_transition_rate;
+        typedef AppliedLikelihood::particle_transition_rate
+            particle_transition_rate;
+        typedef AppliedLikelihood::directional_probabilities
+            directional_probabilities;
+        typedef AppliedLikelihood::particle_transition_probability
+            particle_transition_probability;
+
+        typedef AppliedLikelihood::ParticleType ParticleType;
+
+        typedef std::vector<std::unique_ptr<AppliedLikelihood>>
+            LikelihoodSeqType;
+        typedef std::vector<NStepProposal<ParticleType>> ProposalSeqType;
+
+        typedef BootstrapParticleFilter<
+            ParticleType, ProposalSeqType, LikelihoodSeqType
+        > FilterType;
+
+    private:
+
+        Rcpp::XPtr<RookDirectionalStatespace> statespace;
+
+        // model, which the particles reference
+        Eigen::VectorXd beta;
+        base_transition_rate location_based_rate;
+        uniformized_transition_rate uniformized_rate;
+        particle_transition_rate transition_rate;
+        directional_probabilities directional_probs;
+        particle_transition_probability transition_prob;
+
+        // observation model
+        double uere;
+
+        NStepProposal<ParticleType> step_proposal;
+        AppliedFlatLikelihood flat_likelihood;
+
+        FilterType filter;
+        NullObserver<ParticleType> observer;
+
+        std::size_t lag;
+
+        // states and ancestor indices for the particles in the most recent
+        // lag + 1 filtering distributions, with timepoint t in slot
+        // t % (lag + 1)
+        std::vector<std::vector<StateType*>> history_states;
+        std::vector<std::vector<std::size_t>> history_ancestors;
+
+        // scratch space for tracing ancestors
+        std::vector<std::size_t> lineage;
+
+        /**
+         * Filter one timepoint and record the filtering distribution
+        */
+        double advance(AppliedLikelihood & likelihood);
+
+    public:
+
+        /**
+         * @param domain statespace the initial states belong to
+         * @param states initial latent states, one for each particle
+         * @param smoothing_lag number of timepoints to smooth over
+         * @param directional_persistence,beta_init,delta model parameters
+         * @param gps_uere user equivalent range error for GPS observations
+        */
+        FixedLagSmoother(
+            Rcpp::XPtr<RookDirectionalStatespace> domain,
+            const std::vector<StateType*> & states, std::size_t smoothing_lag,
+            double directional_persistence,
+            const Eigen::Ref<const Eigen::VectorXd> & beta_init, double delta,
+            double gps_uere
+        );
+
+        FixedLagSmoother(const FixedLagSmoother &) = delete;
+        FixedLagSmoother & operator=(const FixedLagSmoother &) = delete;
+
+        /**
+         * Filter a GPS observation made nsteps timepoints after the previous
+         * observation, or at timepoint nsteps - 1 for the first observation.
+         * Returns the observation's contribution to the log-likelihood, which
+         * is R_NegInf if the filter degenerates.  Degenerate filters ignore
+         * further observations.
+        */
+        double append_observation(
+            double easting, double northing, double hdop, std::size_t nsteps
+        );
+
+        /**
+         * Particle states for the smoothed distribution at timepoint t, which
+         * must be within lag timepoints of the most recent timepoint
+        */
+        std::vector<StateType*> smoothed_at(std::size_t t);
+
+        /**
+         * Number of timepoints filtered so far
+        */
+        std::size_t size() const { return filter.size(); }
+
+        std::size_t smoothing_lag() const { return lag; }
+
+        double loglik() const { return filter.loglik(); }
+
+        bool degenerate() const { return filter.finished(); }
+
+};
+
+#endif
@@ -0,0 +1,158 @@
+/**
+ * Proposal distributions that look ahead to the next observation
+*/
+
+#ifndef MOVECON_LOOKAHEAD_H
+#define MOVECON_LOOKAHEAD_H
+
+#include <Rcpp.h>
+
+#include "ProjectedLocationLikelihood.h"
+
+/**
+ * Twisted proposal distribution that tilts a particle's transition
+ * distribution toward the next observation.
+ *
+ * The tilt approximates the predictive density of the next observation given
+ * a candidate state by inflating the observation's error distribution with the
+ * variance of the movement that can occur in the steps that remain before the
+ * observation.  At observation times, the tilt is the observation likelihood
+ * itself, which yields the locally optimal proposal.
+ *
+ * Following twisted SMC, the filter's intermediate targets between 
+ * observations carry the tilt, i.e., the target after step t is the filtering
+ * distribution times the tilt for step t, and the tilt is 1 at observation 
+ * times, so targets at observation times are the filtering distributions.
+ * Resampling between observations then preserves the tilt rather than 
+ * undoing it.  The importance weight for step t is Z_t(x) / tilt_{t-1}(x), in
+ * which Z_t(x) is the normalizing constant for the tilted transition 
+ * distribution from the particle's previous state x, which keeps likelihood 
+ * estimates unbiased for any choice of tilt.
+*/
+template<typename Particle>
+class LookaheadProposal {
+
+    private:
+
+        // approximate predictive distribution for the next observation
+        ProjectedLocationLikelihood predictive;
+        bool has_observation;
+
+        // true if the target after the proposal carries the tilt, i.e., if 
+        // the proposal is not made at an observation time
+        bool tilted_target;
+
+        // tilt carried by the target before the proposal, if any
+        ProjectedLocationLikelihood previous_tilt;
+        bool has_previous_tilt;
+
+        struct PredictivePotential {
+            ProjectedLocationLikelihood * predictive;
+            template<typename State>
+            double operator()(const State & state) {
+                return predictive->dstate(state);
+            }
+        };
+
+    public:
+
+        /**
+         * Build a bootstrap proposal for timepoints after the last observation
+        */
+        LookaheadProposal() :
+            predictive(ProjectedLocationLikelihood::from_hdop_uere(0, 0, 1, 1)),
+            has_observation(false), tilted_target(false),
+            previous_tilt(predictive), has_previous_tilt(false) { }
+
+        /**
+         * @param observation distribution for the next observation
+         * @param nsteps number of steps that will remain before the next
+         *   observation after the proposal is made
+         * @param step_sd standard deviation of the movement along each
+         *   coordinate axis during a single step
+        */
+        LookaheadProposal(
+            const ProjectedLocationLikelihood & observation, std::size_t nsteps,
+            double step_sd
+        ) : predictive(observation.inflate(nsteps * step_sd * step_sd)),
+            has_observation(true), tilted_target(nsteps > 0),
+            previous_tilt(predictive), has_previous_tilt(false) { }
+
+        /**
+         * Account for the tilt carried by the target of the proposal made 
+         * before this one
+        */
+        void follow(const LookaheadProposal & previous) {
+            has_previous_tilt = previous.tilted_target;
+            if(has_previous_tilt) {
+                previous_tilt = previous.predictive;
+            }
+        }
+
+        double propose(Particle & particle) {
+            // remove the previous target's tilt
+            double log_w = 0;
+            if(has_previous_tilt) {
+                log_w -= previous_tilt.dstate(*particle.state);
+            }
+            if(!has_observation) {
+                particle.step();
+                return log_w;
+            }
+            // twisted_step returns log Z_t(x) - log tilt_t(x'), so the tilt 
+            // is restored if the target after the proposal carries it
+            PredictivePotential potential{&predictive};
+            log_w += particle.twisted_step(potential);
+            if(tilted_target && log_w != R_NegInf) {
+                log_w += predictive.dstate(*particle.state);
+            }
+            return log_w;
+        }
+
+};
+
+/**
+ * Create a family of lookahead proposal distributions for GPS observations
+ * made at discrete time indices, with one proposal for each timepoint
+ *
+ * @param t vector of discrete time indices (starting at 0) at which
+ *   observations are available
+ * @param nt total number of discrete timepoints
+ * @param step_sd standard deviation of the movement along each coordinate
+ *   axis during a single step
+*/
+template<typename Particle>
+std::vector<LookaheadProposal<Particle>> LookaheadFamilyFromGPS(
+    std::vector<double> eastings, std::vector<double> northings,
+    std::vector<double> hdops, double uere, std::vector<std::size_t> t,
+    std::size_t nt, double step_sd
+) {
+    std::vector<LookaheadProposal<Particle>> family;
+    family.reserve(nt);
+
+    std::vector<ProjectedLocationLikelihood> observations =
+        LocationDistributionFamilyFromGPS(eastings, northings, hdops, uere);
+
+    auto t_it = t.begin();
+    auto t_end = t.end();
+    auto observation = observations.begin();
+    for(std::size_t ind = 0; ind < nt; ++ind) {
+        // advance to the next observation
+        if(t_it != t_end && *t_it < ind) {
+            ++t_it;
+            ++observation;
+        }
+        if(t_it == t_end) {
+            family.emplace_back();
+        } else {
+            family.emplace_back(*observation, *t_it - ind, step_sd);
+        }
+        if(ind > 0) {
+            family[ind].follow(family[ind - 1]);
+        }
+    }
+
+    return family;
+}
+
+#endif
@@ -0,0 +1,176 @@
+#include "ParticleFilter.h"
+
+#include "Particle.h"
+#include "Domain.h"
+#include "Directions.h"
+#include "AppliedLikelihood.h"
+#include "TransitionTable.h"
+#include "Random.h"
+
+#include <RcppEigen.h>
+
+// [[Rcpp::depends(RcppEigen)]]
+
+/**
+ * Particle filter approximations to the marginal log-likelihood for a batch of
+ * K model parameter sets, i.e., for grid searches and profile likelihoods.
+ *
+ * Transition rates and probabilities for all K parameter sets are evaluated
+ * in a single pass through the statespace.  The K filters then run in
+ * lockstep through the observations, sharing the observation model and the
+ * proposal distributions.  All filters use copies of the same random number
+ * stream (i.e., common random numbers), so differences between the
+ * log-likelihood estimates are mostly due to differences between the
+ * parameter sets rather than Monte Carlo noise.  Each particle draws from its
+ * own block of the stream at each timepoint, and the filters resample 
+ * systematically after sorting particles along a Hilbert curve, so particles
+ * that move differently in different filters only slightly perturb how the 
+ * other particles are resampled.  The estimates are therefore much smoother 
+ * functions of the parameters than independent estimates, although the 
+ * coupling weakens when observation errors are small relative to the grid 
+ * cells.
+ *
+ * @param t vector of discrete time indices (starting at 0) at which
+ *   observations are available
+ * @param nt total number of discrete timepoints
+ * @param statespace Object constructed from \code{build_statespace}
+ * @param initial_latent_state_sample Sample of states, i.e., from
+ *   \code{sample_gaussian_states_from_hdop_uere}
+ * @param directional_persistence vector with the directional persistence for
+ *   each of the K parameter sets
+ * @param beta matrix whose K columns are the location-based movement
+ *   parameters for each parameter set
+ * @param delta uniformization constant
+*/
+// [[Rcpp::export]]
+std::vector<double> Particle_Filter_Likelihood_From_GPS_Parameter_Batch(
+    /* likelihood components */
+    std::vector<double> eastings, std::vector<double> northings,
+    std::vector<double> hdops, double uere, std::vector<std::size_t> t,
+    std::size_t nt,
+    /* filter components */
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::XPtr<
+        std::vector<RookDirectionalStatespace::StateType*>
+    > initial_latent_state_sample,
+    /* model parameters */
+    std::vector<double> directional_persistence, Eigen::MatrixXd beta,
+    double delta
+) {
+
+    typedef RookDirectionalStatespace::StateType StateType;
+
+    typedef table_rate_evaluator<StateType> particle_transition_rate;
+    typedef table_transition_probability_evaluator<StateType>
+        particle_transition_probability;
+
+    typedef Particle<
+        StateType,
+        particle_transition_rate,
+        particle_transition_probability,
+        BlockStreamRandom
+    > ParticleType;
+
+    typedef std::vector<std::unique_ptr<AppliedLikelihood>> LikelihoodSeqType;
+    typedef std::vector<NStepProposal<ParticleType>> ProposalSeqType;
+
+    typedef BootstrapParticleFilter<
+        ParticleType,
+        ProposalSeqType,
+        LikelihoodSeqType,
+        NullObserver<ParticleType>,
+        BlockStreamRandom
+    > FilterType;
+
+    std::size_t K = directional_persistence.size();
+    if(static_cast<std::size_t>(beta.cols()) != K) {
+        Rcpp::stop(
+            "Argument beta must have one column for each "
+            "directional_persistence"
+        );
+    }
+    if(initial_latent_state_sample->empty()) {
+        Rcpp::stop("Argument initial_latent_state_sample must not be empty");
+    }
+    if(
+        beta.rows() !=
+        initial_latent_state_sample->front()->properties.location->x.size()
+    ) {
+        Rcpp::stop("Argument beta must have one row for each covariate");
+    }
+
+    //
+    // shared components
+    //
+
+    TransitionTableBatch table = TransitionTableBatch::build<
+        RookDirectionalStatespace, CardinalDirectionOrientations
+    >(*statespace, directional_persistence, beta, delta);
+
+    LikelihoodSeqType likelihood_seq = AppliedLikelihoodFamilyFromGPS(
+        eastings, northings, hdops, uere, t, nt
+    );
+
+    ProposalSeqType proposal_seq =
+        ConstantStepFamily<ParticleType>(likelihood_seq.size(), 1);
+
+    //
+    // build one filter for each parameter set
+    //
+
+    // common random numbers for all filters
+    std::vector<BlockStreamRandom> random_sources(
+        K, BlockStreamRandom::from_r()
+    );
+
+    std::vector<particle_transition_rate> transition_rates;
+    std::vector<particle_transition_probability> transition_probs;
+    transition_rates.reserve(K);
+    transition_probs.reserve(K);
+    for(std::size_t k = 0; k < K; ++k) {
+        transition_rates.emplace_back(table, k);
+        transition_probs.emplace_back(table, k);
+    }
+
+    std::vector<std::unique_ptr<FilterType>> filters;
+    filters.reserve(K);
+    std::vector<ParticleType> particles;
+    particles.reserve(initial_latent_state_sample->size());
+    for(std::size_t k = 0; k < K; ++k) {
+        particles.clear();
+        ParticleType particle(
+            transition_rates[k], transition_probs[k], random_sources[k]
+        );
+        for(auto state : *initial_latent_state_sample) {
+            particle.state = state;
+            particles.push_back(particle);
+        }
+        filters.emplace_back(new FilterType(particles));
+        filters.back()->proposal_distributions = &proposal_seq;
+        filters.back()->likelihoods = &likelihood_seq;
+        filters.back()->random_source = &random_sources[k];
+        filters.back()->correlated = true;
+        filters.back()->initialize();
+    }
+
+    //
+    // run filters in lockstep through the observations
+    //
+
+    NullObserver<ParticleType> observer;
+    for(std::size_t ind = 0; ind < likelihood_seq.size(); ++ind) {
+        for(auto & filter : filters) {
+            if(!filter->finished()) {
+                filter->advance(observer);
+            }
+        }
+    }
+
+    std::vector<double> ll;
+    ll.reserve(K);
+    for(auto & filter : filters) {
+        ll.push_back(filter->loglik());
+    }
+
+    return ll;
+}
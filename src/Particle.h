@@ -3,12 +3,16 @@
 
 #include <Rcpp.h>
 
+#include "Random.h"
+
 template<
     typename StateType, 
     // Type that can evaluate Hewitt et. al. (2023) eq. 14
     typename transition_rate_evaluator,
     // Type that can evaluate Hewitt et. al. (2023) eq. 15
-    typename transition_probability_evaluator
+    typename transition_probability_evaluator,
+    // Type that can generate random numbers
+    typename RandomSource = RRandom
 >
 struct Particle {
 
@@ -16,16 +20,30 @@ struct Particle {
 
         transition_rate_evaluator* m_rate_evaluator;
         transition_probability_evaluator* m_probability_evaluator;
+        RandomSource* m_random_source;
 
     public:
 
+        // largest number of random draws step() uses, i.e., to size blocks of
+        // auxiliary random variables
+        static constexpr std::size_t max_step_draws = 2;
+
         StateType* state; 
 
         Particle(
             transition_rate_evaluator & rate_evaluator,
             transition_probability_evaluator & probability_evaluator
         ) : m_rate_evaluator(&rate_evaluator), 
-            m_probability_evaluator(&probability_evaluator) { }
+            m_probability_evaluator(&probability_evaluator),
+            m_random_source(&default_random_source<RandomSource>()) { }
+
+        Particle(
+            transition_rate_evaluator & rate_evaluator,
+            transition_probability_evaluator & probability_evaluator,
+            RandomSource & random_source
+        ) : m_rate_evaluator(&rate_evaluator), 
+            m_probability_evaluator(&probability_evaluator),
+            m_random_source(&random_source) { }
 
         /**
          * forward-simulation using discretized transition distribution
@@ -35,7 +53,7 @@ struct Particle {
             double uniformized_rate = m_rate_evaluator->transition_rate(*state);
             
             // test for self-transition, then move
-            if(R::runif(0, 1) < 1 - uniformized_rate) {
+            if(m_random_source->runif() < 1 - uniformized_rate) {
                 // self-transition, do nothing
             } else {
                 
@@ -44,7 +62,7 @@ struct Particle {
                     m_probability_evaluator->probabilities(*state).data();
                 
                 // transition to random neighbor
-                double p = R::runif(0, 1);
+                double p = m_random_source->runif();
                 double cumulative_mass = 0;
                 for(auto destination : state->to) {
                     // aggregate transition mass from neighbor
@@ -66,10 +84,79 @@ struct Particle {
                 step();
         }
 
+        /**
+         * forward-simulation using a twisted version of the discretized 
+         * transition distribution, in which the mass for each destination 
+         * (including a self-transition) is reweighted by a potential function.
+         * 
+         * Returns the log of the importance weight correction needed for the 
+         * twisted step to target the untwisted model, i.e., 
+         * log(sum_y p(y|x) potential(y)) - log(potential(new state)).  Returns 
+         * -Inf without moving the particle if the potential is 0 for all 
+         * destinations.
+         * 
+         * @param log_potential function object that returns the log of the 
+         *   (non-negative) potential for a state
+        */
+        template<typename Potential>
+        double twisted_step(Potential & log_potential) {
+
+            // scratch space for the log-mass of each destination, with the 
+            // self-transition in the first position
+            static thread_local std::vector<double> log_mass;
+            log_mass.resize(state->to.size() + 1);
+
+            double uniformized_rate = m_rate_evaluator->transition_rate(*state);
+            const double * mass = 
+                m_probability_evaluator->probabilities(*state).data();
+
+            // twisted mass for self-transition and transitions to neighbors
+            auto log_mass_it = log_mass.begin();
+            *(log_mass_it++) = std::log(1 - uniformized_rate) + 
+                log_potential(*state);
+            double log_rate = std::log(uniformized_rate);
+            for(auto destination : state->to) {
+                *(log_mass_it++) = log_rate + std::log(*(mass++)) + 
+                    log_potential(*destination);
+            }
+
+            // normalizing constant for twisted transition distribution
+            double log_max = *std::max_element(
+                log_mass.begin(), log_mass.end()
+            );
+            if(log_max == R_NegInf) {
+                return R_NegInf;
+            }
+            double total_mass = 0;
+            for(auto & lm : log_mass) {
+                lm = std::exp(lm - log_max);
+                total_mass += lm;
+            }
+
+            // sample destination from twisted transition distribution
+            double p = m_random_source->runif() * total_mass;
+            double cumulative_mass = log_mass[0];
+            if(cumulative_mass <= p) {
+                auto mass_it = log_mass.begin() + 1;
+                for(auto destination : state->to) {
+                    cumulative_mass += *(mass_it++);
+                    if(cumulative_mass > p) {
+                        state = destination;
+                        break;
+                    }
+                }
+            }
+
+            return log_max + std::log(total_mass) - log_potential(*state);
+        }
+
 };
 
 /**
  * Wrapper to call a particle's member step function nstep times.
+ * 
+ * Proposal distributions return the log of the importance weight correction 
+ * for the proposal, which is always 0 for bootstrap proposals.
 */
 template<typename Particle>
 class NStepProposal {
@@ -82,8 +169,16 @@ class NStepProposal {
 
         NStepProposal(std::size_t n) : nsteps(n) { }
 
-        void propose(Particle & particle) {
+        /**
+         * Largest number of random draws propose() uses
+        */
+        std::size_t max_draws() const {
+            return nsteps * Particle::max_step_draws;
+        }
+
+        double propose(Particle & particle) {
             particle.step(nsteps);
+            return 0;
         }
 
 };
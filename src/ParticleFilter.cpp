@@ -5,29 +5,42 @@
 #include "Tx.h"
 #include "Directions.h"
 #include "AppliedLikelihood.h"
+#include "Reachability.h"
+#include "Lookahead.h"
+#include "FilterRecording.h"
+#include "ParticleGillespie.h"
+#include "CovariateStack.h"
+#include "DirectionalBias.h"
 
 #include <RcppEigen.h>
 
 // [[Rcpp::depends(RcppEigen)]]
 
-Rcpp::List run_particle_filter(
+/**
+ * Run a particle filter for the movement model, using a sequence of proposal
+ * distributions that contains one proposal for each discrete timepoint, and
+ * passing each filtering distribution to an observer.  Returns the marginal
+ * log-likelihood.
+*/
+template<typename ProposalSeqType, typename Observer>
+double filter_particles(
     /* likelihood components */
     std::vector<std::unique_ptr<AppliedLikelihood>> & likelihood_seq,
+    /* proposal components */
+    ProposalSeqType & proposal_seq,
     /* filter components */
     Rcpp::XPtr<RookDirectionalStatespace> & statespace,
     Rcpp::XPtr<
         std::vector<RookDirectionalStatespace::StateType*>
     > & initial_latent_state_sample,
     /* model parameters */
-    double directional_persistence, Eigen::VectorXd & beta, double delta
+    double directional_persistence, Eigen::VectorXd & beta, double delta,
+    /* output */
+    Observer & observer
 ) {
 
     // reset cached state values
-    auto end = statespace->states.end();
-    for(auto state = statespace->states.begin(); state != end; ++state) {
-        state->second.to_rate = -1;
-        state->second.to_probabilities.resize(0);
-    }
+    statespace->reset_transition_cache();
 
     //
     // configurations
@@ -58,8 +71,6 @@ Rcpp::List run_particle_filter(
         particle_transition_probability
     > ParticleType;
 
-    typedef std::vector<NStepProposal<ParticleType>> ProposalSeqType;
-
     typedef std::vector<std::unique_ptr<AppliedLikelihood>> LikelihoodSeqType;
 
     //
@@ -90,14 +101,6 @@ Rcpp::List run_particle_filter(
         particles.push_back(particle);
     }
 
-    //
-    // build proposal distributions
-    //
-
-    ProposalSeqType proposal_seq = ConstantStepFamily<ParticleType>(
-        likelihood_seq.size(), 1
-    );
-
     //
     // build particle filter
     //
@@ -106,27 +109,31 @@ Rcpp::List run_particle_filter(
         ParticleType, 
         ProposalSeqType, 
         LikelihoodSeqType,
-        FilterObserver<ParticleType>
+        Observer
     > 
     pf(particles);
 
     pf.proposal_distributions = &proposal_seq;
     pf.likelihoods = &likelihood_seq;
 
-    // raw storage for filtering distributions
-    FilterObserver<ParticleType> filtering_distributions;
-
     // run particle filter
-    double ll = pf.marginal_ll(filtering_distributions);
+    return pf.marginal_ll(observer);
+}
 
-    //
-    // export filtering distributions as an array
-    //
+/**
+ * Export filtering distributions as an array of coordinates, with dimensions 
+ * (coordinate, particle, distribution)
+*/
+template<typename ParticleType>
+Rcpp::NumericVector filtering_coordinates(
+    const FilterObserver<ParticleType> & filtering_distributions, 
+    std::size_t nparticles
+) {
 
     Rcpp::NumericVector filtering_locations(
         Rcpp::Dimension(
             2, // coordinates
-            particles.size(), // particles
+            nparticles, // particles
             filtering_distributions.particle_distributions.size() // dist'ns.
         )
     );
@@ -146,11 +153,45 @@ Rcpp::List run_particle_filter(
         } // particle
     } // distribution
 
+    return filtering_locations;
+}
+
+/**
+ * Run a particle filter for the movement model, using a sequence of proposal
+ * distributions that contains one proposal for each discrete timepoint
+*/
+template<typename ProposalSeqType>
+Rcpp::List run_particle_filter(
+    /* likelihood components */
+    std::vector<std::unique_ptr<AppliedLikelihood>> & likelihood_seq,
+    /* proposal components */
+    ProposalSeqType & proposal_seq,
+    /* filter components */
+    Rcpp::XPtr<RookDirectionalStatespace> & statespace,
+    Rcpp::XPtr<
+        std::vector<RookDirectionalStatespace::StateType*>
+    > & initial_latent_state_sample,
+    /* model parameters */
+    double directional_persistence, Eigen::VectorXd & beta, double delta
+) {
+
+    typedef AppliedLikelihood::ParticleType ParticleType;
+
+    // raw storage for filtering distributions
+    FilterObserver<ParticleType> filtering_distributions;
+
+    // run particle filter
+    double ll = filter_particles(
+        likelihood_seq, proposal_seq, statespace, initial_latent_state_sample,
+        directional_persistence, beta, delta, filtering_distributions
+    );
 
     // package results
     return Rcpp::List::create(
         Rcpp::Named("ll") = ll,
-        Rcpp::Named("filtering_distributions") = filtering_locations
+        Rcpp::Named("filtering_distributions") = filtering_coordinates(
+            filtering_distributions, initial_latent_state_sample->size()
+        )
     );
 }
 
@@ -177,8 +218,13 @@ Rcpp::List Test__Particle_Filter_Likelihood(
         eastings, northings, semi_majors, semi_minors, orientations, t, nt
     );
 
+    typedef AppliedLikelihood::ParticleType ParticleType;
+
+    std::vector<NStepProposal<ParticleType>> proposal_seq = 
+        ConstantStepFamily<ParticleType>(likelihood_seq.size(), 1);
+
     return run_particle_filter(
-        likelihood_seq, statespace, initial_latent_state_sample,
+        likelihood_seq, proposal_seq, statespace, initial_latent_state_sample,
         directional_persistence, beta, delta
     );
 }
@@ -204,8 +250,652 @@ Rcpp::List Particle_Filter_Likelihood_From_GPS(
         eastings, northings, hdops, uere, t, nt
     );
 
+    typedef AppliedLikelihood::ParticleType ParticleType;
+
+    std::vector<NStepProposal<ParticleType>> proposal_seq = 
+        ConstantStepFamily<ParticleType>(likelihood_seq.size(), 1);
+
     return run_particle_filter(
-        likelihood_seq, statespace, initial_latent_state_sample,
+        likelihood_seq, proposal_seq, statespace, initial_latent_state_sample,
         directional_persistence, beta, delta
     );
 }
+
+/**
+ * Particle filter approximation to the likelihood for GPS observations, using
+ * hop distance fields to prune or guide particles that cannot reach the
+ * support of the next observation in time.
+ * 
+ * Pruning requires each observation's likelihood to vanish outside of the 
+ * support used to build the hop distance fields, so observation errors are 
+ * truncated to the nsigma-contour of the error distribution.  The filter 
+ * returns an unbiased estimate of the likelihood for the truncated errors, 
+ * which approximates the likelihood for untruncated errors, as returned by 
+ * \code{Particle_Filter_Likelihood_From_GPS}, when nsigma is large.
+ * 
+ * @param reachability Object constructed from 
+ *   \code{build_reachability_from_gps} for the same observations
+ * @param guided true to simulate particles from the transition distribution 
+ *   restricted to states that can reach the next observation, false to 
+ *   simulate from the bootstrap proposal and discard particles that cannot 
+ *   reach the next observation
+*/
+// [[Rcpp::export]]
+Rcpp::List Particle_Filter_Likelihood_From_GPS_With_Reachability(
+    /* likelihood components */
+    std::vector<double> eastings, std::vector<double> northings, 
+    std::vector<double> hdops, double uere, std::vector<std::size_t> t,
+    std::size_t nt,
+    /* filter components */
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::XPtr<
+        std::vector<RookDirectionalStatespace::StateType*>
+    > initial_latent_state_sample,
+    Rcpp::XPtr<RookDirectionalReachability> reachability,
+    bool guided,
+    /* model parameters */
+    double directional_persistence, Eigen::VectorXd beta, double delta
+) {
+    
+    typedef std::vector<std::unique_ptr<AppliedLikelihood>> LikelihoodSeqType;
+    typedef AppliedLikelihood::ParticleType ParticleType;
+    typedef RookDirectionalStatespace::StateType StateType;
+
+    if(reachability->nt != nt) {
+        Rcpp::stop("Argument reachability was built for a different timeline");
+    }
+
+    // observation errors are truncated to the fields' support
+    LikelihoodSeqType likelihood_seq = 
+        AppliedTruncatedLikelihoodFamilyFromGPS(
+            eastings, northings, hdops, uere, t, nt, reachability->nsigma
+        );
+
+    std::vector<ReachabilityProposal<ParticleType, StateType>> proposal_seq = 
+        reachability->proposals<ParticleType>(guided);
+
+    return run_particle_filter(
+        likelihood_seq, proposal_seq, statespace, initial_latent_state_sample,
+        directional_persistence, beta, delta
+    );
+}
+
+/**
+ * Particle filter approximation to the likelihood for GPS observations, using
+ * proposal distributions that tilt particle movement toward the next 
+ * observation.  Tilting reduces the number of particles needed to achieve a 
+ * given likelihood variance when observations are precise.
+ * 
+ * @param step_sd standard deviation of the movement along each coordinate 
+ *   axis during a single step, used to approximate the predictive distribution
+ *   for the next observation
+*/
+// [[Rcpp::export]]
+Rcpp::List Particle_Filter_Likelihood_From_GPS_With_Lookahead(
+    /* likelihood components */
+    std::vector<double> eastings, std::vector<double> northings, 
+    std::vector<double> hdops, double uere, std::vector<std::size_t> t,
+    std::size_t nt,
+    /* filter components */
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::XPtr<
+        std::vector<RookDirectionalStatespace::StateType*>
+    > initial_latent_state_sample,
+    double step_sd,
+    /* model parameters */
+    double directional_persistence, Eigen::VectorXd beta, double delta
+) {
+    
+    typedef std::vector<std::unique_ptr<AppliedLikelihood>> LikelihoodSeqType;
+    typedef AppliedLikelihood::ParticleType ParticleType;
+
+    LikelihoodSeqType likelihood_seq = AppliedLikelihoodFamilyFromGPS(
+        eastings, northings, hdops, uere, t, nt
+    );
+
+    std::vector<LookaheadProposal<ParticleType>> proposal_seq = 
+        LookaheadFamilyFromGPS<ParticleType>(
+            eastings, northings, hdops, uere, t, nt, step_sd
+        );
+
+    return run_particle_filter(
+        likelihood_seq, proposal_seq, statespace, initial_latent_state_sample,
+        directional_persistence, beta, delta
+    );
+}
+
+/**
+ * Particle filter approximation to the likelihood for GPS observations made at
+ * arbitrary times, which simulates particles in continuous time via the 
+ * Gillespie algorithm between observations rather than stepping through a 
+ * discretized timeline.  The filter's cost depends on the number of 
+ * transitions particles make rather than the time resolution, and the 
+ * filtering distributions are only computed at the observation times.
+ * 
+ * Particles read transition rates and probabilities from the statespace's 
+ * cache, and draw holding times from R's random number generator.
+ * 
+ * @param times increasing observation times, in the units of the transition 
+ *   rates.  The initial latent states describe the first observation time.
+ * @return list with the log-likelihood, and an array of filtering 
+ *   distributions with one slice for each observation
+*/
+// [[Rcpp::export]]
+Rcpp::List Particle_Filter_Likelihood_From_GPS_Gillespie(
+    /* likelihood components */
+    std::vector<double> eastings, std::vector<double> northings, 
+    std::vector<double> hdops, double uere, std::vector<double> times,
+    /* filter components */
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::XPtr<
+        std::vector<RookDirectionalStatespace::StateType*>
+    > initial_latent_state_sample,
+    /* model parameters */
+    double directional_persistence, Eigen::VectorXd beta
+) {
+
+    typedef std::vector<std::unique_ptr<AppliedLikelihood>> LikelihoodSeqType;
+    typedef AppliedLikelihood::StateType StateType;
+
+    typedef AppliedLikelihood::base_transition_rate base_transition_rate;
+    typedef AppliedLikelihood::uniformized_transition_rate 
+        uniformized_transition_rate;
+    typedef AppliedLikelihood::particle_transition_rate 
+        particle_transition_rate;
+    typedef AppliedLikelihood::directional_probabilities 
+        directional_probabilities;
+    typedef AppliedLikelihood::particle_transition_probability 
+        particle_transition_probability;
+
+    typedef ParticleGillespie<
+        StateType,
+        particle_transition_rate,
+        particle_transition_probability
+    > ParticleType;
+
+    if(times.size() != eastings.size()) {
+        Rcpp::stop("Arguments times and eastings must have equal length");
+    }
+    if(!std::is_sorted(times.begin(), times.end())) {
+        Rcpp::stop("Argument times must be in increasing order");
+    }
+
+    // one likelihood for each observation
+    std::vector<std::size_t> t(times.size());
+    std::iota(t.begin(), t.end(), 0);
+    LikelihoodSeqType likelihood_seq = AppliedLikelihoodFamilyFromGPS(
+        eastings, northings, hdops, uere, t, t.size()
+    );
+
+    std::vector<GillespieProposal<ParticleType>> proposal_seq = 
+        ObservationTimeFamily<ParticleType>(times);
+
+    // reset cached state values
+    statespace->reset_transition_cache();
+
+    // the Gillespie algorithm uses the unscaled transition rates
+    base_transition_rate location_based_rate(beta);
+    uniformized_transition_rate uniformized_rate(&location_based_rate, 1);
+    particle_transition_rate transition_rate(uniformized_rate);
+    directional_probabilities directional_probs(directional_persistence);
+    particle_transition_probability transition_prob(directional_probs);
+
+    // build particles for the initial states
+    std::vector<ParticleType> particles;
+    particles.reserve(initial_latent_state_sample->size());
+    ParticleType particle(transition_rate, transition_prob);
+    for(auto state : *initial_latent_state_sample) {
+        particle.state = state;
+        particles.push_back(particle);
+    }
+
+    BootstrapParticleFilter<
+        ParticleType, 
+        std::vector<GillespieProposal<ParticleType>>, 
+        LikelihoodSeqType,
+        FilterObserver<ParticleType>
+    > 
+    pf(particles);
+
+    pf.proposal_distributions = &proposal_seq;
+    pf.likelihoods = &likelihood_seq;
+
+    FilterObserver<ParticleType> filtering_distributions;
+    double ll = pf.marginal_ll(filtering_distributions);
+
+    return Rcpp::List::create(
+        Rcpp::Named("ll") = ll,
+        Rcpp::Named("filtering_distributions") = filtering_coordinates(
+            filtering_distributions, initial_latent_state_sample->size()
+        )
+    );
+}
+
+/**
+ * Particle filter approximation to the likelihood for GPS observations, for 
+ * movement models whose location-based covariates vary over time.  The 
+ * transition rates for each step use the covariate layer active at the 
+ * step's timepoint, read from rate tables cached in the covariate stack.
+ * 
+ * @param stack Object constructed from \code{build_covariate_stack} for the 
+ *   statespace
+*/
+// [[Rcpp::export]]
+Rcpp::List Particle_Filter_Likelihood_From_GPS_Time_Varying(
+    /* likelihood components */
+    std::vector<double> eastings, std::vector<double> northings, 
+    std::vector<double> hdops, double uere, std::vector<std::size_t> t,
+    std::size_t nt,
+    /* filter components */
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::XPtr<
+        std::vector<RookDirectionalStatespace::StateType*>
+    > initial_latent_state_sample,
+    Rcpp::XPtr<CovariateStack> stack,
+    /* model parameters */
+    double directional_persistence, Eigen::VectorXd beta, double delta
+) {
+
+    typedef std::vector<std::unique_ptr<AppliedLikelihood>> LikelihoodSeqType;
+    typedef AppliedLikelihood::StateType StateType;
+
+    typedef time_varying_location_based_movement<StateType> 
+        time_varying_transition_rate;
+    typedef AppliedLikelihood::directional_probabilities 
+        directional_probabilities;
+    typedef AppliedLikelihood::particle_transition_probability 
+        particle_transition_probability;
+
+    typedef Particle<
+        StateType, 
+        time_varying_transition_rate, 
+        particle_transition_probability
+    > ParticleType;
+
+    typedef TimeVaryingStepProposal<
+        ParticleType, time_varying_transition_rate
+    > ProposalType;
+
+    if(stack->nlocations() != statespace->grid.size()) {
+        Rcpp::stop("Argument stack was built for a different statespace");
+    }
+    if(static_cast<std::size_t>(beta.size()) != stack->ncovariates()) {
+        Rcpp::stop("Argument beta has the wrong length");
+    }
+
+    LikelihoodSeqType likelihood_seq = AppliedLikelihoodFamilyFromGPS(
+        eastings, northings, hdops, uere, t, nt
+    );
+
+    // reset cached state values
+    statespace->reset_transition_cache();
+
+    // transition rates change over time, so are read from the stack's 
+    // tables rather than cached in the statespace
+    time_varying_transition_rate transition_rate(*stack, beta, delta);
+    directional_probabilities directional_probs(directional_persistence);
+    particle_transition_probability transition_prob(directional_probs);
+
+    std::vector<ProposalType> proposal_seq = 
+        TimeVaryingStepFamily<ParticleType>(transition_rate, nt);
+
+    // build particles for the initial states
+    std::vector<ParticleType> particles;
+    particles.reserve(initial_latent_state_sample->size());
+    ParticleType particle(transition_rate, transition_prob);
+    for(auto state : *initial_latent_state_sample) {
+        particle.state = state;
+        particles.push_back(particle);
+    }
+
+    BootstrapParticleFilter<
+        ParticleType, 
+        std::vector<ProposalType>, 
+        LikelihoodSeqType,
+        FilterObserver<ParticleType>
+    > 
+    pf(particles);
+
+    pf.proposal_distributions = &proposal_seq;
+    pf.likelihoods = &likelihood_seq;
+
+    FilterObserver<ParticleType> filtering_distributions;
+    double ll = pf.marginal_ll(filtering_distributions);
+
+    return Rcpp::List::create(
+        Rcpp::Named("ll") = ll,
+        Rcpp::Named("filtering_distributions") = filtering_coordinates(
+            filtering_distributions, initial_latent_state_sample->size()
+        )
+    );
+}
+
+/**
+ * Particle filter approximation to the likelihood for GPS observations, for 
+ * movement models whose transition probabilities include directional bias 
+ * from covariate gradients in addition to directional persistence.
+ * 
+ * @param bias Object constructed from \code{build_directional_bias} for the 
+ *   statespace
+ * @param gamma coefficients for the directional covariates
+*/
+// [[Rcpp::export]]
+Rcpp::List Particle_Filter_Likelihood_From_GPS_With_Directional_Bias(
+    /* likelihood components */
+    std::vector<double> eastings, std::vector<double> northings, 
+    std::vector<double> hdops, double uere, std::vector<std::size_t> t,
+    std::size_t nt,
+    /* filter components */
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::XPtr<
+        std::vector<RookDirectionalStatespace::StateType*>
+    > initial_latent_state_sample,
+    Rcpp::XPtr<RookDirectionalBias> bias,
+    /* model parameters */
+    double directional_persistence, Eigen::VectorXd beta, 
+    Eigen::VectorXd gamma, double delta
+) {
+
+    typedef std::vector<std::unique_ptr<AppliedLikelihood>> LikelihoodSeqType;
+    typedef AppliedLikelihood::StateType StateType;
+
+    typedef AppliedLikelihood::base_transition_rate base_transition_rate;
+    typedef AppliedLikelihood::uniformized_transition_rate 
+        uniformized_transition_rate;
+    typedef AppliedLikelihood::particle_transition_rate 
+        particle_transition_rate;
+
+    typedef Particle<
+        StateType, 
+        particle_transition_rate, 
+        RookDirectionalBias
+    > ParticleType;
+
+    if(bias->nstates() != statespace->states.size()) {
+        Rcpp::stop("Argument bias was built for a different statespace");
+    }
+    if(static_cast<std::size_t>(gamma.size()) != bias->ncovariates()) {
+        Rcpp::stop("Argument gamma has the wrong length");
+    }
+
+    LikelihoodSeqType likelihood_seq = AppliedLikelihoodFamilyFromGPS(
+        eastings, northings, hdops, uere, t, nt
+    );
+
+    std::vector<NStepProposal<ParticleType>> proposal_seq = 
+        ConstantStepFamily<ParticleType>(likelihood_seq.size(), 1);
+
+    // reset cached state values
+    statespace->reset_transition_cache();
+
+    base_transition_rate location_based_rate(beta);
+    uniformized_transition_rate uniformized_rate(&location_based_rate, delta);
+    particle_transition_rate transition_rate(uniformized_rate);
+
+    // evaluate transition probabilities for all links at once
+    bias->set_parameters(directional_persistence, gamma);
+
+    // build particles for the initial states
+    std::vector<ParticleType> particles;
+    particles.reserve(initial_latent_state_sample->size());
+    ParticleType particle(transition_rate, *bias);
+    for(auto state : *initial_latent_state_sample) {
+        particle.state = state;
+        particles.push_back(particle);
+    }
+
+    BootstrapParticleFilter<
+        ParticleType, 
+        std::vector<NStepProposal<ParticleType>>, 
+        LikelihoodSeqType,
+        FilterObserver<ParticleType>
+    > 
+    pf(particles);
+
+    pf.proposal_distributions = &proposal_seq;
+    pf.likelihoods = &likelihood_seq;
+
+    FilterObserver<ParticleType> filtering_distributions;
+    double ll = pf.marginal_ll(filtering_distributions);
+
+    return Rcpp::List::create(
+        Rcpp::Named("ll") = ll,
+        Rcpp::Named("filtering_distributions") = filtering_coordinates(
+            filtering_distributions, initial_latent_state_sample->size()
+        )
+    );
+}
+
+/**
+ * Timepoints at which to record filtering distributions, i.e., every stride'th
+ * timepoint, or the observation times t if stride is 0
+*/
+RecordingSchedule recording_schedule(
+    std::vector<std::size_t> t, std::size_t stride
+) {
+    if(stride > 0) {
+        return RecordingSchedule(stride);
+    }
+    std::sort(t.begin(), t.end());
+    return RecordingSchedule(t);
+}
+
+/**
+ * Particle filter approximation to the likelihood for GPS observations, 
+ * recording filtering distributions as state ids rather than coordinates.  
+ * State ids are 0-based positions within the statespace, and may be mapped to 
+ * locations via \code{statespace_state_locations}.  Recording only the 
+ * observation times, or every stride'th timepoint, further reduces the 
+ * memory required for long tracks.
+ * 
+ * @param stride record every stride'th timepoint, starting with the first, or
+ *   only the observation times t if stride is 0
+ * @return list with the log-likelihood, the 0-based timepoints that were 
+ *   recorded, and a matrix of state ids with one column for each recorded
+ *   timepoint
+*/
+// [[Rcpp::export]]
+Rcpp::List Particle_Filter_State_Ids_From_GPS(
+    /* likelihood components */
+    std::vector<double> eastings, std::vector<double> northings, 
+    std::vector<double> hdops, double uere, std::vector<std::size_t> t,
+    std::size_t nt,
+    /* filter components */
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::XPtr<
+        std::vector<RookDirectionalStatespace::StateType*>
+    > initial_latent_state_sample,
+    /* model parameters */
+    double directional_persistence, Eigen::VectorXd beta, double delta,
+    /* output components */
+    std::size_t stride = 0
+) {
+    
+    typedef std::vector<std::unique_ptr<AppliedLikelihood>> LikelihoodSeqType;
+    typedef AppliedLikelihood::ParticleType ParticleType;
+
+    LikelihoodSeqType likelihood_seq = AppliedLikelihoodFamilyFromGPS(
+        eastings, northings, hdops, uere, t, nt
+    );
+
+    std::vector<NStepProposal<ParticleType>> proposal_seq = 
+        ConstantStepFamily<ParticleType>(likelihood_seq.size(), 1);
+
+    StateIdObserver<ParticleType> observer(recording_schedule(t, stride));
+
+    double ll = filter_particles(
+        likelihood_seq, proposal_seq, statespace, initial_latent_state_sample,
+        directional_persistence, beta, delta, observer
+    );
+
+    // export state ids with one column per recorded timepoint
+    Rcpp::IntegerMatrix state_ids(
+        initial_latent_state_sample->size(), observer.timepoints.size()
+    );
+    std::copy(
+        observer.state_ids.begin(), observer.state_ids.end(), state_ids.begin()
+    );
+
+    return Rcpp::List::create(
+        Rcpp::Named("ll") = ll,
+        Rcpp::Named("timepoints") = observer.timepoints,
+        Rcpp::Named("state_ids") = state_ids
+    );
+}
+
+/**
+ * Particle filter approximation to the likelihood for GPS observations, 
+ * streaming filtering distributions to a binary file as state ids while the 
+ * filter runs, so memory use does not depend on the length of the track.  
+ * Use \code{read_state_id_file} to load the file.
+ * 
+ * @param path file to write, which will be overwritten if it exists
+ * @param stride record every stride'th timepoint, starting with the first, or
+ *   only the observation times t if stride is 0
+ * @return list with the log-likelihood and the number of recorded timepoints
+*/
+// [[Rcpp::export]]
+Rcpp::List Particle_Filter_State_Ids_To_File_From_GPS(
+    /* likelihood components */
+    std::vector<double> eastings, std::vector<double> northings, 
+    std::vector<double> hdops, double uere, std::vector<std::size_t> t,
+    std::size_t nt,
+    /* filter components */
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::XPtr<
+        std::vector<RookDirectionalStatespace::StateType*>
+    > initial_latent_state_sample,
+    /* model parameters */
+    double directional_persistence, Eigen::VectorXd beta, double delta,
+    /* output components */
+    std::string path, std::size_t stride = 0
+) {
+    
+    typedef std::vector<std::unique_ptr<AppliedLikelihood>> LikelihoodSeqType;
+    typedef AppliedLikelihood::ParticleType ParticleType;
+
+    LikelihoodSeqType likelihood_seq = AppliedLikelihoodFamilyFromGPS(
+        eastings, northings, hdops, uere, t, nt
+    );
+
+    std::vector<NStepProposal<ParticleType>> proposal_seq = 
+        ConstantStepFamily<ParticleType>(likelihood_seq.size(), 1);
+
+    StateIdFileObserver<ParticleType> observer(
+        path, recording_schedule(t, stride)
+    );
+    if(!observer.good()) {
+        Rcpp::stop("Unable to open file " + path);
+    }
+
+    double ll = filter_particles(
+        likelihood_seq, proposal_seq, statespace, initial_latent_state_sample,
+        directional_persistence, beta, delta, observer
+    );
+
+    if(!observer.close()) {
+        Rcpp::stop("Unable to write file " + path);
+    }
+
+    return Rcpp::List::create(
+        Rcpp::Named("ll") = ll,
+        Rcpp::Named("ntimepoints") = observer.size()
+    );
+}
+
+/**
+ * Particle filter approximation to the likelihood for GPS observations, 
+ * counting particles in each grid cell while the filter runs, i.e., to build 
+ * spatial histograms of the filtering distributions without exporting them.
+ * 
+ * @param window number of discrete timepoints to combine into each histogram,
+ *   or 0 to build a single histogram for all timepoints
+ * @param stride count particles at every stride'th timepoint, starting with 
+ *   the first, or only at the observation times t if stride is 0
+ * @return list with the log-likelihood; an array of particle counts with 
+ *   dimensions (easting, northing, window), ordered as the eastings and 
+ *   northings used to build statespace; the coordinates along each grid axis;
+ *   the number of filtering distributions counted in each window; and the 
+ *   coordinates and counts of the grid cells that contain particles in any
+ *   window
+*/
+// [[Rcpp::export]]
+Rcpp::List Particle_Filter_Occupancy_From_GPS(
+    /* likelihood components */
+    std::vector<double> eastings, std::vector<double> northings, 
+    std::vector<double> hdops, double uere, std::vector<std::size_t> t,
+    std::size_t nt,
+    /* filter components */
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::XPtr<
+        std::vector<RookDirectionalStatespace::StateType*>
+    > initial_latent_state_sample,
+    /* model parameters */
+    double directional_persistence, Eigen::VectorXd beta, double delta,
+    /* output components */
+    std::size_t window = 0, std::size_t stride = 1
+) {
+    
+    typedef std::vector<std::unique_ptr<AppliedLikelihood>> LikelihoodSeqType;
+    typedef AppliedLikelihood::ParticleType ParticleType;
+
+    LikelihoodSeqType likelihood_seq = AppliedLikelihoodFamilyFromGPS(
+        eastings, northings, hdops, uere, t, nt
+    );
+
+    std::vector<NStepProposal<ParticleType>> proposal_seq = 
+        ConstantStepFamily<ParticleType>(likelihood_seq.size(), 1);
+
+    OccupancyGrid grid(*statespace);
+    OccupancyObserver<ParticleType> observer(
+        grid, nt, window, recording_schedule(t, stride)
+    );
+
+    double ll = filter_particles(
+        likelihood_seq, proposal_seq, statespace, initial_latent_state_sample,
+        directional_persistence, beta, delta, observer
+    );
+
+    // export counts as a raster
+    std::size_t nwindows = observer.nwindows();
+    Rcpp::NumericVector counts(
+        Rcpp::Dimension(grid.neastings, grid.nnorthings, nwindows)
+    );
+    std::copy(observer.counts.begin(), observer.counts.end(), counts.begin());
+
+    // identify cells that contain particles in any window
+    std::vector<std::size_t> occupied;
+    for(std::size_t cell = 0; cell < grid.size(); ++cell) {
+        for(std::size_t w = 0; w < nwindows; ++w) {
+            if(observer.counts[cell + w * grid.size()] > 0) {
+                occupied.push_back(cell);
+                break;
+            }
+        }
+    }
+
+    // export occupied cells' coordinates and counts
+    Rcpp::NumericVector cell_eastings(occupied.size());
+    Rcpp::NumericVector cell_northings(occupied.size());
+    Rcpp::NumericMatrix cell_counts(occupied.size(), nwindows);
+    for(std::size_t i = 0; i < occupied.size(); ++i) {
+        cell_eastings[i] = grid.eastings[occupied[i] % grid.neastings];
+        cell_northings[i] = grid.northings[occupied[i] / grid.neastings];
+        for(std::size_t w = 0; w < nwindows; ++w) {
+            cell_counts(i, w) = observer.counts[occupied[i] + w * grid.size()];
+        }
+    }
+
+    return Rcpp::List::create(
+        Rcpp::Named("ll") = ll,
+        Rcpp::Named("counts") = counts,
+        Rcpp::Named("eastings") = grid.eastings,
+        Rcpp::Named("northings") = grid.northings,
+        Rcpp::Named("ndistributions") = observer.ndistributions,
+        Rcpp::Named("occupied") = Rcpp::List::create(
+            Rcpp::Named("easting") = cell_eastings,
+            Rcpp::Named("northing") = cell_northings,
+            Rcpp::Named("counts") = cell_counts
+        )
+    );
+}
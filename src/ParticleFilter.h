@@ -4,6 +4,8 @@
 #include <Rcpp.h>
 
 #include "log_add.h"
+#include "Random.h"
+#include "SpaceFillingCurve.h"
 
 /**
  * The BootstrapParticleFilter uses an observer concept to export filtering 
@@ -31,7 +33,8 @@ template<
     typename Particle, 
     typename ProposalDistributionSequence, 
     typename LikelihoodSequence,
-    typename Observer = NullObserver<Particle>
+    typename Observer = NullObserver<Particle>,
+    typename RandomSource = RRandom
 > 
 class BootstrapParticleFilter {
 
@@ -39,6 +42,36 @@ class BootstrapParticleFilter {
 
         std::vector<Particle> particles_init;
 
+        // working memory, retained between calls to avoid re-allocation
+        std::vector<Particle> particles_A, particles_B;
+        std::vector<double> log_unnormalized_weights;
+
+        // index of each resampled particle's ancestor within the previous 
+        // filtering distribution
+        std::vector<std::size_t> ancestor_indices;
+
+        // scratch space for sorted resampling
+        std::vector<std::size_t> resampling_order;
+        std::vector<std::uint64_t> resampling_keys;
+
+        // progress through the observations
+        typename ProposalDistributionSequence::iterator proposal_distn;
+        typename LikelihoodSequence::iterator likelihood;
+        std::size_t timepoint;
+        double ll;
+        bool degenerate;
+
+        // early termination: upper bounds on the total log-likelihood 
+        // contributions from all observations and from those filtered so far
+        double ll_bound_total;
+        double ll_bound_filtered;
+        bool stopped;
+
+        // number of observations, i.e., timepoints with likelihoods that are 
+        // not flat, in total and filtered so far
+        std::size_t nobs_total;
+        std::size_t nobs_filtered;
+
         // convert a pointer to a reference if needed
         template<typename T> 
         T& asReference(std::unique_ptr<T> & x) { return  *x; }
@@ -49,14 +82,87 @@ class BootstrapParticleFilter {
 
     public:
 
+        /**
+         * Progress through the observations, i.e., to checkpoint long runs
+        */
+        struct Progress {
+            std::size_t timepoint;
+            double ll;
+            bool degenerate;
+            bool stopped;
+            double ll_bound_total;
+            double ll_bound_filtered;
+            std::size_t nobs_total;
+            std::size_t nobs_filtered;
+        };
+
         ProposalDistributionSequence * proposal_distributions;
         LikelihoodSequence * likelihoods;
+        RandomSource * random_source;
+
+        /**
+         * Correlated pseudo-marginal mode (Deligiannidis et. al., 2018, doi:
+         * 10.1111/rssb.12280).  If true, particles are sorted along a Hilbert
+         * curve through their locations and resampled via systematic 
+         * resampling, and the random source moves to a new block of random 
+         * numbers before each particle is proposed and before resampling.  
+         * Particles must draw from the filter's random source.  Together, 
+         * these keep likelihood estimates strongly correlated when the random
+         * source's auxiliary variables are only slightly perturbed.
+        */
+        bool correlated;
+
+        /**
+         * Early termination, i.e., for MH samplers that reject a proposal if 
+         * its log-likelihood ends up below a known threshold, which is the 
+         * current log-likelihood plus the log of the acceptance uniform minus
+         * the log-prior difference.  The filter stops, and truncated() 
+         * reports true, once the running log-likelihood plus an upper bound 
+         * on the contributions from the remaining observations falls below 
+         * the threshold.  The filter's estimate would have ended below the 
+         * threshold had it run to completion, so stopping never changes an 
+         * MH decision.  Bounds assume the proposals' log-weight corrections 
+         * are at most 0, as for bootstrap proposals.  The default threshold, 
+         * R_NegInf, disables early termination.
+        */
+        double termination_threshold;
+
+        /**
+         * Approximate early termination.  If finite, the filter also stops 
+         * once a projection of its final log-likelihood falls more than 
+         * termination_margin below termination_threshold.  The projection 
+         * assumes each remaining observation falls short of its upper bound
+         * by the average shortfall for the observations filtered so far, in
+         * which observations are timepoints whose likelihoods are not flat.  
+         * Projections are noisy, particularly early in the series, so the 
+         * filter sometimes stops for proposals that would have been 
+         * accepted, which biases MH samplers toward the current parameters.
+         * Larger margins reduce the bias but stop fewer filters early; small
+         * margins save the most work and let samplers run more iterations, 
+         * which reduces Monte Carlo variance for a fixed computing budget.
+         * The default margin, R_PosInf, disables approximate termination.
+        */
+        double termination_margin;
 
         /**
          * @param particles initial particles
         */
         BootstrapParticleFilter(const std::vector<Particle> & particles) : 
-            particles_init(particles) { }
+            particles_init(particles), timepoint(0), ll(0), degenerate(false),
+            ll_bound_total(0), ll_bound_filtered(0), stopped(false),
+            nobs_total(0), nobs_filtered(0),
+            proposal_distributions(nullptr), likelihoods(nullptr),
+            random_source(&default_random_source<RandomSource>()),
+            correlated(false), termination_threshold(R_NegInf), 
+            termination_margin(R_PosInf) { }
+
+        /**
+         * Access the initial particles, i.e., to update them in place before 
+         * re-running the filter
+        */
+        std::vector<Particle> & initial_particles() {
+            return particles_init;
+        }
 
         /**
          *  Particle filter approximation to marginal log-likelihood using 
@@ -73,101 +179,333 @@ class BootstrapParticleFilter {
          * 10.18637/jss.v100.i03)
         */
         double marginal_ll(Observer & observer) {
+            initialize();
+            while(!finished()) {
+                advance(observer);
+            }
+            return ll;
+        }
 
-            // initialize log-likelihood
-            double ll = 0;
+        /**
+         * Prepare to filter the observations one at a time via advance(), 
+         * i.e., to run several filters in lockstep
+        */
+        void initialize() {
 
-            // particle filter size
-            std::size_t M = particles_init.size();
-            double log_M = std::log(M);
+            // initialize log-likelihood
+            ll = 0;
+            degenerate = false;
+            stopped = false;
+            timepoint = 0;
 
             // set initial particle values (line 2)
-            std::vector<Particle> particles_A = particles_init;
-            std::vector<Particle>* active_particles = &particles_A;
-
-            // compute initial weights (line 3)
-            double log_uniform_weight = -std::log(M);
+            particles_A = particles_init;
 
             // prepare container for unnormalized weights (line 8)
-            std::vector<double> log_unnormalized_weights(M);
+            log_unnormalized_weights.resize(particles_init.size());
 
             // prepare container for resampling (line 14)
-            std::vector<Particle> particles_B;
-            particles_B.reserve(M);
-            std::vector<Particle>* resampled_particles = &particles_B;
-
-            // iterate over observations (line 5)
-            auto proposal_distn = proposal_distributions->begin();
-            auto proposal_distn_end = proposal_distributions->end();
-            auto likelihood = likelihoods->begin();
-            for(; proposal_distn != proposal_distn_end; ++proposal_distn) {
-
-                // evaluate proposal distributions and importance weights
-                auto particle = active_particles->begin();
-                auto particle_end = active_particles->end();
-                auto log_w = log_unnormalized_weights.begin();
-                for(; particle != particle_end; ++particle) {
-                    // sample from proposal distribution (line 7)
-                    proposal_distn->propose(*particle);
-                    // compute log-importance weight (line 8)
-                    // Note: weight will always be uniform
-                    *(log_w++) = asReference(*likelihood).dparticle(*particle) + 
-                        log_uniform_weight;
+            particles_B.clear();
+            particles_B.reserve(particles_init.size());
+            ancestor_indices.clear();
+            ancestor_indices.reserve(particles_init.size());
+
+            // filters without sequences are advanced one step at a time, 
+            // with the proposal and likelihood supplied for each step
+            if(!proposal_distributions || !likelihoods) {
+                return;
+            }
+
+            // start at the first observation (line 5)
+            proposal_distn = proposal_distributions->begin();
+            likelihood = likelihoods->begin();
+
+            // bound the log-likelihood for early termination
+            ll_bound_total = 0;
+            ll_bound_filtered = 0;
+            nobs_total = 0;
+            nobs_filtered = 0;
+            if(termination_threshold != R_NegInf) {
+                auto likelihood_end = likelihoods->end();
+                for(auto lik = likelihood; lik != likelihood_end; ++lik) {
+                    double log_max = asReference(*lik).log_max_density();
+                    ll_bound_total += log_max;
+                    nobs_total += log_max != 0;
                 }
+            }
+        }
 
-                // normalize resampling weights and resample (lines 11, 14, 15)
-                std::size_t nresample = M;
-                particle = active_particles->begin();
-                resampled_particles->clear();
-                double log_mass = log_sum(log_unnormalized_weights);
-                log_w = log_unnormalized_weights.begin();
-                auto log_w_stop = log_unnormalized_weights.end() - 1;
-                for(; log_w != log_w_stop; ++log_w) {
-                    // normalized resampling weight (line 11)
-                    double p = std::exp(*log_w - log_mass);
-                    // resample particles using R::multinom strategy
-                    // (see R source code: R-XXX/src/nmath/rmultinom.c)
-                    if(p != 0) {
-                        // number of times to use particle (line 14)
-                        std::size_t n = static_cast<std::size_t>(
-                            R::rbinom(nresample, p)
-                        );
-                        // transfer n copies of current particle (line 15)
-                        if(n > 0) {
-                            nresample -= n;
-                            resampled_particles->insert(
-                                resampled_particles->end(), n, *particle
-                            );
-                        }
-                    }
-                    // iterate particle
-                    ++particle;
+        /**
+         * true if all observations have been filtered, if all particles 
+         * have had zero weight at an earlier observation, or if the filter 
+         * stopped early
+        */
+        bool finished() const {
+            return degenerate || stopped || (proposal_distributions &&
+                proposal_distn == proposal_distributions->end());
+        }
+
+        /**
+         * true if the filter stopped early because its log-likelihood would 
+         * fall below termination_threshold, in which case loglik() only 
+         * includes the observations filtered before the filter stopped
+        */
+        bool truncated() const {
+            return stopped;
+        }
+
+        /**
+         * Approximate marginal log-likelihood for the observations filtered 
+         * since initialize() was called
+        */
+        double loglik() const {
+            return ll;
+        }
+
+        /**
+         * Current filtering distribution
+        */
+        const std::vector<Particle> & particles() const {
+            return particles_A;
+        }
+
+        /**
+         * For each particle in the current filtering distribution, the index 
+         * of its ancestor within the previous filtering distribution, i.e., 
+         * to trace particle genealogies
+        */
+        const std::vector<std::size_t> & ancestors() const {
+            return ancestor_indices;
+        }
+
+        Progress progress() const {
+            return Progress{
+                timepoint, ll, degenerate, stopped, ll_bound_total,
+                ll_bound_filtered, nobs_total, nobs_filtered
+            };
+        }
+
+        /**
+         * Continue filtering from a checkpoint, i.e., a filter's progress(),
+         * particles(), and ancestors() at an earlier point in the same 
+         * sequences.  The filter's random source must also be restored for 
+         * the resumed filter to match an uninterrupted run.  The sequences
+         * must support random access.
+        */
+        void resume(
+            const Progress & checkpoint, 
+            const std::vector<Particle> & particles,
+            const std::vector<std::size_t> & ancestors
+        ) {
+            initialize();
+            timepoint = checkpoint.timepoint;
+            ll = checkpoint.ll;
+            degenerate = checkpoint.degenerate;
+            stopped = checkpoint.stopped;
+            ll_bound_total = checkpoint.ll_bound_total;
+            ll_bound_filtered = checkpoint.ll_bound_filtered;
+            nobs_total = checkpoint.nobs_total;
+            nobs_filtered = checkpoint.nobs_filtered;
+            particles_A = particles;
+            ancestor_indices = ancestors;
+            log_unnormalized_weights.resize(particles_A.size());
+            particles_B.reserve(particles_A.size());
+            proposal_distn = proposal_distributions->begin() + timepoint;
+            likelihood = likelihoods->begin() + timepoint;
+        }
+
+        /**
+         * Number of timepoints filtered since initialize() was called
+        */
+        std::size_t size() const {
+            return timepoint;
+        }
+
+        /**
+         * Filter the next observation, returning its incremental contribution
+         * to the marginal log-likelihood.  The filter stops if all particles 
+         * have zero weight, since the likelihood is then zero.
+        */
+        double advance(Observer & observer) {
+            double ll_t = advance(
+                *proposal_distn, asReference(*likelihood), observer
+            );
+            if(!degenerate) {
+                ++proposal_distn;
+                ++likelihood;
+            }
+            return ll_t;
+        }
+
+        /**
+         * Filter the next observation using a proposal and likelihood for 
+         * the step, rather than the filter's sequences, i.e., to filter 
+         * observations as they arrive.  The likelihood's log_max_density() 
+         * is only used for early termination, which requires the filter's 
+         * sequences.
+        */
+        template<typename Proposal, typename Likelihood>
+        double advance(
+            Proposal & proposal, Likelihood & likelihood, Observer & observer
+        ) {
+
+            // particle filter size
+            std::size_t M = particles_A.size();
+
+            // compute initial weights (line 3)
+            double log_uniform_weight = -std::log(M);
+
+            // evaluate proposal distributions and importance weights
+            auto particle = particles_A.begin();
+            auto particle_end = particles_A.end();
+            auto log_w = log_unnormalized_weights.begin();
+            std::size_t block = timepoint * (M + 1);
+            for(; particle != particle_end; ++particle) {
+                if(correlated) {
+                    seek_random_block(*random_source, block++);
                 }
-                
-                // transfer final particle, if needed
-                if(nresample > 0) {
-                    resampled_particles->insert(
-                        resampled_particles->end(), nresample, *particle
-                    );
+                // sample from proposal distribution (line 7), which also 
+                // returns the log-importance weight correction for the 
+                // proposal (i.e., 0 for bootstrap proposals)
+                double log_q = proposal.propose(*particle);
+                // compute log-importance weight (line 8)
+                // Note: weight will always be uniform
+                *(log_w++) = log_q + 
+                    likelihood.dparticle(*particle) + 
+                    log_uniform_weight;
+            }
+
+            // normalize resampling weights and resample (lines 11, 14, 15)
+            particles_B.clear();
+            ancestor_indices.clear();
+            double log_mass = log_sum(log_unnormalized_weights);
+
+            // all particles have zero weight, so likelihood is zero
+            if(log_mass == R_NegInf) {
+                degenerate = true;
+                ll = R_NegInf;
+                return R_NegInf;
+            }
+
+            if(correlated) {
+                seek_random_block(*random_source, block);
+                sorted_systematic_resample(log_mass);
+            } else {
+                multinomial_resample(log_mass);
+            }
+
+            // aggregate likelihood mass (line 18); the weights include the 
+            // uniform initial weights, so the mass is already the average 
+            // likelihood across particles, and scaling it by 1/M again would
+            // bias each contribution by -log(M)
+            double ll_t = log_mass;
+            ll += ll_t;
+
+            // stop if the final log-likelihood will be below the threshold
+            if(termination_threshold != R_NegInf && proposal_distributions) {
+                double log_max = likelihood.log_max_density();
+                ll_bound_filtered += log_max;
+                nobs_filtered += log_max != 0;
+                double ll_bound = ll + ll_bound_total - ll_bound_filtered;
+                if(ll_bound < termination_threshold) {
+                    stopped = true;
+                } else if(termination_margin != R_PosInf && nobs_filtered > 0) {
+                    // project the shortfall from the bound per observation
+                    double shortfall = ll_bound_filtered - ll;
+                    double ll_projected = ll_bound - shortfall * 
+                        (nobs_total - nobs_filtered) / nobs_filtered;
+                    stopped = ll_projected < 
+                        termination_threshold - termination_margin;
                 }
+            }
 
-                // aggregate likelihood mass (line 18)
-                double ll_t = log_mass - log_M;
-                ll += ll_t;
+            // update particles
+            particles_A.swap(particles_B);
 
-                // update particles
-                std::swap(active_particles, resampled_particles);
+            // provide opportunity to export filtering distributions, etc.
+            observer(particles_A, ll_t);
 
-                // provide opportunity to export filtering distributions, etc.
-                observer(*active_particles, ll_t);
+            // move to next observation
+            ++timepoint;
 
-                // increment likelihood
-                ++likelihood;
+            return ll_t;
+        } // advance()
 
-            } // iterate over observations (line 5)
+    private:
 
-            return ll;
-        } // marginal_ll()
+        /**
+         * Resample particles_A into particles_B using normalized weights
+        */
+        void multinomial_resample(double log_mass) {
+            std::size_t nresample = particles_A.size();
+            auto particle = particles_A.begin();
+            auto log_w = log_unnormalized_weights.begin();
+            auto log_w_stop = log_unnormalized_weights.end() - 1;
+            double remaining_mass = 1;
+            for(; log_w != log_w_stop; ++log_w) {
+                // normalized resampling weight (line 11)
+                double p = std::exp(*log_w - log_mass);
+                // resample particles using R::multinom strategy
+                // (see R source code: R-XXX/src/nmath/rmultinom.c)
+                if(p != 0) {
+                    // number of times to use particle (line 14), drawn 
+                    // conditionally on the mass not yet resampled
+                    double p_remaining = p / remaining_mass;
+                    std::size_t n = p_remaining < 1 ? 
+                        random_source->rbinom(nresample, p_remaining) : 
+                        nresample;
+                    // transfer n copies of current particle (line 15)
+                    if(n > 0) {
+                        nresample -= n;
+                        particles_B.insert(particles_B.end(), n, *particle);
+                        ancestor_indices.insert(
+                            ancestor_indices.end(), n, 
+                            particle - particles_A.begin()
+                        );
+                    }
+                }
+                if(nresample == 0) {
+                    break;
+                }
+                remaining_mass -= p;
+                // iterate particle
+                ++particle;
+            }
+            
+            // transfer final particle, if needed
+            if(nresample > 0) {
+                particles_B.insert(particles_B.end(), nresample, *particle);
+                ancestor_indices.insert(
+                    ancestor_indices.end(), nresample, 
+                    particle - particles_A.begin()
+                );
+            }
+        }
+
+        /**
+         * Resample particles_A into particles_B via systematic resampling of 
+         * particles sorted along a Hilbert curve, which uses a single random 
+         * number and keeps the resampled particles in curve order
+        */
+        void sorted_systematic_resample(double log_mass) {
+            std::size_t M = particles_A.size();
+            hilbert_sort(particles_A, resampling_order, resampling_keys);
+            double u = random_source->runif();
+            auto ind = resampling_order.begin();
+            auto ind_last = resampling_order.end() - 1;
+            double cumulative_mass = 
+                std::exp(log_unnormalized_weights[*ind] - log_mass);
+            for(std::size_t k = 0; k < M; ++k) {
+                double target = (k + u) / M;
+                while(cumulative_mass < target && ind != ind_last) {
+                    ++ind;
+                    cumulative_mass += 
+                        std::exp(log_unnormalized_weights[*ind] - log_mass);
+                }
+                particles_B.push_back(particles_A[*ind]);
+                ancestor_indices.push_back(*ind);
+            }
+        }
 
 };
 
@@ -3,12 +3,18 @@
 
 #include <Rcpp.h>
 
+#include "Random.h"
+
+#include <vector>
+
 template<
     typename StateType, 
     // Type that can evaluate Hewitt et. al. (2023) eq. 14
     typename transition_rate_evaluator,
     // Type that can evaluate Hewitt et. al. (2023) eq. 15
-    typename transition_probability_evaluator
+    typename transition_probability_evaluator,
+    // Type that can generate random numbers
+    typename RandomSource = RRandom
 >
 struct ParticleGillespie {
 
@@ -16,6 +22,7 @@ struct ParticleGillespie {
 
         transition_rate_evaluator* m_rate_evaluator;
         transition_probability_evaluator* m_probability_evaluator;
+        RandomSource* m_random_source;
 
     public:
 
@@ -25,21 +32,42 @@ struct ParticleGillespie {
             transition_rate_evaluator & rate_evaluator,
             transition_probability_evaluator & probability_evaluator
         ) : m_rate_evaluator(&rate_evaluator), 
-            m_probability_evaluator(&probability_evaluator) { }
+            m_probability_evaluator(&probability_evaluator),
+            m_random_source(&default_random_source<RandomSource>()) { }
+
+        ParticleGillespie(
+            transition_rate_evaluator & rate_evaluator,
+            transition_probability_evaluator & probability_evaluator,
+            RandomSource & random_source
+        ) : m_rate_evaluator(&rate_evaluator), 
+            m_probability_evaluator(&probability_evaluator),
+            m_random_source(&random_source) { }
 
         /**
          * Forward simulation via Gillespie algorithm.
         */
         void step(double t, double tnext) {
+            auto ignore = [](double time, const StateType & destination) { };
+            step(t, tnext, ignore);
+        }
+
+        /**
+         * Forward simulation via Gillespie algorithm, which also reports each
+         * transition's time and destination to an observer, i.e., to record 
+         * the continuous-time path
+        */
+        template<typename Observer>
+        void step(double t, double tnext, Observer & observer) {
             // initial time increment
-            t += R::rexp(1 / m_rate_evaluator->transition_rate(*state));
+            t += m_random_source->rexp() / 
+                m_rate_evaluator->transition_rate(*state);
             // transition to neighbors while able (i.e., before tnext)
             while(t < tnext) {
                 // get transition probabilities
                 const double * mass = 
                     m_probability_evaluator->probabilities(*state).data();
                 // transition to random neighbor
-                double p = R::runif(0, 1);
+                double p = m_random_source->runif();
                 double cumulative_mass = 0;
                 for(auto destination : state->to) {
                     // aggregate transition mass from neighbor
@@ -47,14 +75,62 @@ struct ParticleGillespie {
                     if(cumulative_mass > p) {
                         // transition to neighbor
                         state = destination;
+                        observer(t, *state);
                         break;
                     }
                 }
                 // increment time
-                t += R::rexp(1 / m_rate_evaluator->transition_rate(*state));
+                t += m_random_source->rexp() / 
+                    m_rate_evaluator->transition_rate(*state);
             }
         } // step function
 
 }; 
 
+/**
+ * Proposal distribution that moves a particle forward in continuous time for 
+ * a fixed duration via the Gillespie algorithm, i.e., between the timestamps
+ * of consecutive observations, so the cost of a proposal depends on the 
+ * number of transitions rather than a time discretization.
+ * 
+ * Proposal distributions return the log of the importance weight correction 
+ * for the proposal, which is always 0 for bootstrap proposals.
+*/
+template<typename Particle>
+class GillespieProposal {
+
+    private:
+
+        double duration;
+
+    public:
+
+        GillespieProposal(double d) : duration(d) { }
+
+        double propose(Particle & particle) {
+            particle.step(0, duration);
+            return 0;
+        }
+
+};
+
+/**
+ * Create a family of proposal distributions that move particles between 
+ * observation times.  The first proposal does not move particles, i.e., the 
+ * initial latent states describe the first observation time.
+ * 
+ * @param times increasing observation times
+*/
+template<typename Particle>
+std::vector<GillespieProposal<Particle>> ObservationTimeFamily(
+    const std::vector<double> & times
+) {
+    std::vector<GillespieProposal<Particle>> family;
+    family.reserve(times.size());
+    for(std::size_t i = 0; i < times.size(); ++i) {
+        family.emplace_back(i == 0 ? 0 : times[i] - times[i - 1]);
+    }
+    return family;
+}
+
 #endif
@@ -0,0 +1,513 @@
+#include "ParticleMCMC.h"
+#include "ThreadPool.h"
+
+ParameterPrior ParameterPrior::from_list(Rcpp::List spec) {
+    std::string family = spec["family"];
+    ParameterPrior res;
+    res.a = 0;
+    res.b = 0;
+    if(family == "flat") {
+        res.family = flat;
+    } else if(family == "normal") {
+        res.family = normal;
+        res.a = spec["mean"];
+        res.b = spec["sd"];
+        if(!(res.b > 0)) {
+            Rcpp::stop("Normal priors must have a positive sd");
+        }
+    } else if(family == "uniform") {
+        res.family = uniform;
+        res.a = spec["min"];
+        res.b = spec["max"];
+        if(!(res.a < res.b)) {
+            Rcpp::stop("Uniform priors must have min < max");
+        }
+    } else {
+        Rcpp::stop("Prior family must be one of: flat, normal, uniform");
+    }
+    return res;
+}
+
+double ParameterPrior::log_density(double x) const {
+    switch(family) {
+        case normal: {
+            double z = (x - a) / b;
+            return -0.5 * z * z - std::log(b) - M_LN_SQRT_2PI;
+        }
+        case uniform:
+            return (a <= x && x <= b) ? -std::log(b - a) : R_NegInf;
+        default:
+            return 0;
+    }
+}
+
+namespace {
+
+    double log_prior(
+        const std::vector<ParameterPrior> & priors, 
+        const Eigen::VectorXd & theta
+    ) {
+        double res = 0;
+        for(std::size_t i = 0; i < priors.size(); ++i) {
+            res += priors[i].log_density(theta(i));
+        }
+        return res;
+    }
+
+    /**
+     * Gaussian random walk PMMH (Andrieu et. al., 2010, doi:
+     * 10.1111/j.1467-9868.2009.00736.x), writing one column of draws and one
+     * log-likelihood for each iteration.  Returns the number of accepted
+     * proposals.
+     *
+     * Chains may reject proposals before the filter runs via 
+     * Chain::screen, which returns R_NegInf to reject a proposal, or the log 
+     * of the first-stage ratio for a delayed-acceptance test otherwise.  The
+     * acceptance uniform is drawn before the filter runs, so the filter can 
+     * stop early for proposals that will be rejected.
+    */
+    template<typename Chain>
+    std::size_t run_pmmh_chain(
+        Chain & chain, const std::vector<ParameterPrior> & priors,
+        const Eigen::MatrixXd & proposal_chol, const Eigen::VectorXd & init,
+        std::size_t niter, Eigen::MatrixXd & draws,
+        std::vector<double> & ll_trace
+    ) {
+
+        std::size_t npar = init.size();
+
+        Eigen::VectorXd theta = init;
+        double lp = log_prior(priors, theta);
+        double ll = chain.loglik_current(theta);
+
+        Eigen::VectorXd theta_prop(npar);
+        Eigen::VectorXd z(npar);
+        std::size_t accepted = 0;
+
+        for(std::size_t it = 0; it < niter; ++it) {
+
+            // propose new parameters
+            for(std::size_t i = 0; i < npar; ++i) {
+                z(i) = chain.rng.rnorm();
+            }
+            theta_prop.noalias() = theta + proposal_chol * z;
+
+            // only run the filter for parameters with prior support that
+            // pass the chain's screen, if any
+            double lp_prop = log_prior(priors, theta_prop);
+            double log_screen_ratio = lp_prop == R_NegInf ?
+                R_NegInf : chain.screen(theta_prop, lp_prop - lp);
+            if(log_screen_ratio != R_NegInf) {
+                // the proposal is accepted if its log-likelihood exceeds the
+                // threshold, so the filter can stop once it cannot
+                double threshold = std::log(chain.rng.runif()) + ll + lp - 
+                    lp_prop + log_screen_ratio;
+                double ll_prop = chain.loglik_proposal(theta_prop, threshold);
+                if(ll_prop != R_NegInf && ll_prop > threshold) {
+                    theta = theta_prop;
+                    lp = lp_prop;
+                    ll = ll_prop;
+                    chain.accept();
+                    ++accepted;
+                }
+            }
+
+            draws.col(it) = theta;
+            ll_trace[it] = ll;
+        }
+
+        return accepted;
+    }
+
+    /**
+     * Run PMMH chains in parallel and package the output for R
+    */
+    template<typename Chain>
+    Rcpp::List run_pmmh_chains(
+        std::vector<std::unique_ptr<Chain>> & chains,
+        const std::vector<ParameterPrior> & priors,
+        const Eigen::MatrixXd & proposal_chol,
+        const Eigen::MatrixXd & initial_parameters, std::size_t niter,
+        std::size_t nthreads
+    ) {
+
+        std::size_t npar = initial_parameters.rows();
+        std::size_t nchains = chains.size();
+
+        std::vector<Eigen::MatrixXd> draws(
+            nchains, Eigen::MatrixXd(npar, niter)
+        );
+        std::vector<std::vector<double>> ll_traces(
+            nchains, std::vector<double>(niter)
+        );
+        std::vector<std::size_t> accepted(nchains);
+
+        auto run_chain = [&](std::size_t c) {
+            accepted[c] = run_pmmh_chain(
+                *chains[c], priors, proposal_chol, initial_parameters.col(c),
+                niter, draws[c], ll_traces[c]
+            );
+        };
+        WorkStealingPool pool(nthreads);
+        pool.run(std::vector<double>(nchains, 1), run_chain);
+
+        Rcpp::NumericVector draws_out(Rcpp::Dimension(npar, niter, nchains));
+        Rcpp::NumericMatrix ll_out(niter, nchains);
+        Rcpp::NumericVector acceptance_rate(nchains);
+        double * draws_it = draws_out.begin();
+        double * ll_it = ll_out.begin();
+        for(std::size_t c = 0; c < nchains; ++c) {
+            draws_it = std::copy(
+                draws[c].data(), draws[c].data() + npar * niter, draws_it
+            );
+            ll_it = std::copy(ll_traces[c].begin(), ll_traces[c].end(), ll_it);
+            acceptance_rate[c] = niter > 0 ?
+                static_cast<double>(accepted[c]) / niter : 0;
+        }
+
+        return Rcpp::List::create(
+            Rcpp::Named("draws") = draws_out,
+            Rcpp::Named("ll") = ll_out,
+            Rcpp::Named("acceptance_rate") = acceptance_rate
+        );
+    }
+
+    /**
+     * Validate sampler inputs and parse the parameters' priors, on the main
+     * thread.  Returns the lower Cholesky factor of proposal_covariance.
+    */
+    Eigen::MatrixXd validate_pmmh_inputs(
+        const std::vector<RookDirectionalStatespace::StateType*> & 
+            initial_latent_state_sample,
+        Rcpp::List priors, const Eigen::MatrixXd & proposal_covariance,
+        const Eigen::MatrixXd & initial_parameters,
+        std::vector<ParameterPrior> & parameter_priors
+    ) {
+
+        if(initial_latent_state_sample.empty()) {
+            Rcpp::stop(
+                "Argument initial_latent_state_sample must not be empty"
+            );
+        }
+
+        std::size_t npar = 
+            initial_latent_state_sample.front()->properties.location->x.size() 
+            + 1;
+
+        if(static_cast<std::size_t>(initial_parameters.rows()) != npar) {
+            Rcpp::stop(
+                "Argument initial_parameters must have one row for each "
+                "parameter"
+            );
+        }
+        if(
+            static_cast<std::size_t>(proposal_covariance.rows()) != npar ||
+            static_cast<std::size_t>(proposal_covariance.cols()) != npar
+        ) {
+            Rcpp::stop("Argument proposal_covariance has the wrong dimensions");
+        }
+        if(priors.size() != npar) {
+            Rcpp::stop(
+                "Argument priors must have one entry for each parameter"
+            );
+        }
+
+        parameter_priors.clear();
+        parameter_priors.reserve(npar);
+        for(std::size_t i = 0; i < npar; ++i) {
+            parameter_priors.push_back(ParameterPrior::from_list(priors[i]));
+        }
+
+        std::size_t nchains = initial_parameters.cols();
+        for(std::size_t c = 0; c < nchains; ++c) {
+            Eigen::VectorXd init = initial_parameters.col(c);
+            if(log_prior(parameter_priors, init) == R_NegInf) {
+                Rcpp::stop(
+                    "Initial parameters must have positive prior density"
+                );
+            }
+        }
+
+        Eigen::LLT<Eigen::MatrixXd> llt(proposal_covariance);
+        if(llt.info() != Eigen::Success) {
+            Rcpp::stop(
+                "Argument proposal_covariance must be positive definite"
+            );
+        }
+        return llt.matrixL();
+    }
+
+    /**
+     * Independent random number streams for each chain, seeded from R's 
+     * random number generator
+    */
+    std::vector<StreamRandom> chain_streams(std::size_t nchains) {
+        std::vector<StreamRandom> streams;
+        streams.reserve(nchains);
+        streams.push_back(StreamRandom::from_r());
+        for(std::size_t c = 1; c < nchains; ++c) {
+            streams.push_back(streams.back().split());
+        }
+        return streams;
+    }
+
+}
+
+/**
+ * Particle marginal Metropolis-Hastings sampler for the movement model
+ * parameters, given GPS observations.
+ *
+ * Chains use Gaussian random walk proposals and run in parallel, with each
+ * chain drawing random numbers from its own stream seeded from R's random
+ * number generator.  The parameter vector is (directional_persistence, beta),
+ * and the uniformization constant delta is fixed.
+ *
+ * @param t vector of discrete time indices (starting at 0) at which
+ *   observations are available
+ * @param nt total number of discrete timepoints
+ * @param statespace Object constructed from \code{build_statespace}
+ * @param initial_latent_state_sample Sample of states, i.e., from
+ *   \code{sample_gaussian_states_from_hdop_uere}
+ * @param priors list with one prior specification for each parameter, i.e.,
+ *   list(family = "normal", mean = 0, sd = 1), list(family = "uniform",
+ *   min = -1, max = 1), or list(family = "flat")
+ * @param proposal_covariance covariance matrix for random walk proposals
+ * @param initial_parameters matrix whose columns are the initial parameters
+ *   for each chain
+ * @param niter number of iterations for each chain
+ * @param nthreads number of threads to use
+ * @param correlation if positive, run correlated pseudo-marginal chains, in 
+ *   which the filter's auxiliary random variables are updated via 
+ *   Crank-Nicolson proposals with this correlation, and particles are sorted
+ *   along a Hilbert curve before systematic resampling.  Values close to 1
+ *   (i.e., 0.99) keep successive likelihood estimates strongly correlated,
+ *   which allows chains to mix well with far fewer particles.
+ * @return list with an array of parameter draws (parameter x iteration x
+ *   chain), a matrix with the log-likelihood estimate for each draw
+ *   (iteration x chain), and the acceptance rate for each chain
+*/
+// [[Rcpp::export]]
+Rcpp::List Particle_Marginal_MH_From_GPS(
+    /* likelihood components */
+    std::vector<double> eastings, std::vector<double> northings,
+    std::vector<double> hdops, double uere, std::vector<std::size_t> t,
+    std::size_t nt,
+    /* filter components */
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::XPtr<
+        std::vector<RookDirectionalStatespace::StateType*>
+    > initial_latent_state_sample,
+    double delta,
+    /* sampler components */
+    Rcpp::List priors, Eigen::MatrixXd proposal_covariance,
+    Eigen::MatrixXd initial_parameters, std::size_t niter,
+    std::size_t nthreads, double correlation = 0
+) {
+
+    std::size_t nchains = initial_parameters.cols();
+
+    //
+    // validate and marshal inputs on the main thread
+    //
+
+    if(!(correlation >= 0 && correlation < 1)) {
+        Rcpp::stop("Argument correlation must be in [0, 1)");
+    }
+
+    std::vector<ParameterPrior> parameter_priors;
+    Eigen::MatrixXd proposal_chol = validate_pmmh_inputs(
+        *initial_latent_state_sample, priors, proposal_covariance,
+        initial_parameters, parameter_priors
+    );
+
+    // observation model is shared by all chains
+    std::vector<std::unique_ptr<AppliedLikelihood>> likelihood_seq =
+        AppliedLikelihoodFamilyFromGPS(eastings, northings, hdops, uere, t, nt);
+
+    std::vector<StreamRandom> streams = chain_streams(nchains);
+
+    //
+    // build and run chains
+    //
+
+    if(correlation > 0) {
+        std::vector<std::unique_ptr<CorrelatedPmmhChain>> chains;
+        chains.reserve(nchains);
+        for(std::size_t c = 0; c < nchains; ++c) {
+            chains.emplace_back(
+                new CorrelatedPmmhChain(
+                    streams[c], *statespace, *initial_latent_state_sample,
+                    likelihood_seq, delta, correlation
+                )
+            );
+        }
+        return run_pmmh_chains(
+            chains, parameter_priors, proposal_chol, initial_parameters, 
+            niter, nthreads
+        );
+    } 
+
+    std::vector<std::unique_ptr<IndependentPmmhChain>> chains;
+    chains.reserve(nchains);
+    for(std::size_t c = 0; c < nchains; ++c) {
+        chains.emplace_back(
+            new IndependentPmmhChain(
+                streams[c], *statespace, *initial_latent_state_sample,
+                likelihood_seq, delta
+            )
+        );
+    }
+    return run_pmmh_chains(
+        chains, parameter_priors, proposal_chol, initial_parameters, niter,
+        nthreads
+    );
+}
+
+/**
+ * Delayed-acceptance particle marginal Metropolis-Hastings sampler for the 
+ * movement model parameters, given GPS observations.
+ *
+ * Each proposal is first screened with a particle filter on a coarsened copy
+ * of the statespace, in which k x k blocks of grid cells are aggregated and 
+ * their covariates averaged, i.e., as by \code{build_coarse_statespace}.  The
+ * particle filter on the original statespace only runs for proposals that 
+ * pass the screen, and a second acceptance test corrects for the surrogate 
+ * so that chains target the same posterior distribution as 
+ * \code{Particle_Marginal_MH_From_GPS}.  The surrogate also aggregates 
+ * blocks of k discrete timepoints, so that animals cover similar distances on
+ * both grids and the surrogate filter runs for about nt / k timepoints.  The 
+ * surrogate uses the first observation within each block of timepoints.
+ * The surrogate's observation errors may also be truncated to an 
+ * nsigma-contour, in which case the surrogate's likelihood can be zero, and 
+ * proposals that it cannot screen are tested with the standard MH step.
+ *
+ * @param t vector of discrete time indices (starting at 0) at which
+ *   observations are available
+ * @param nt total number of discrete timepoints
+ * @param statespace Object constructed from \code{build_statespace}
+ * @param initial_latent_state_sample Sample of states, i.e., from
+ *   \code{sample_gaussian_states_from_hdop_uere}
+ * @param priors list with one prior specification for each parameter, as for
+ *   \code{Particle_Marginal_MH_From_GPS}
+ * @param proposal_covariance covariance matrix for random walk proposals
+ * @param initial_parameters matrix whose columns are the initial parameters
+ *   for each chain
+ * @param niter number of iterations for each chain
+ * @param coarsening number of grid cells k to aggregate along each grid axis
+ *   for the surrogate
+ * @param nthreads number of threads to use
+ * @param surrogate_nsigma size of the contour to truncate the surrogate's 
+ *   observation errors to, or Inf to use untruncated errors
+ * @return list with an array of parameter draws (parameter x iteration x
+ *   chain), a matrix with the log-likelihood estimate for each draw
+ *   (iteration x chain), the acceptance rate for each chain, and the 
+ *   proportion of each chain's proposals that passed the screen
+*/
+// [[Rcpp::export]]
+Rcpp::List Delayed_Acceptance_MH_From_GPS(
+    /* likelihood components */
+    std::vector<double> eastings, std::vector<double> northings,
+    std::vector<double> hdops, double uere, std::vector<std::size_t> t,
+    std::size_t nt,
+    /* filter components */
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::XPtr<
+        std::vector<RookDirectionalStatespace::StateType*>
+    > initial_latent_state_sample,
+    double delta,
+    /* sampler components */
+    Rcpp::List priors, Eigen::MatrixXd proposal_covariance,
+    Eigen::MatrixXd initial_parameters, std::size_t niter,
+    std::size_t coarsening, std::size_t nthreads, 
+    double surrogate_nsigma = R_PosInf
+) {
+
+    std::size_t nchains = initial_parameters.cols();
+
+    //
+    // validate and marshal inputs on the main thread
+    //
+
+    std::vector<ParameterPrior> parameter_priors;
+    Eigen::MatrixXd proposal_chol = validate_pmmh_inputs(
+        *initial_latent_state_sample, priors, proposal_covariance,
+        initial_parameters, parameter_priors
+    );
+
+    if(coarsening == 0) {
+        Rcpp::stop("Argument coarsening must be positive");
+    }
+    if(!(surrogate_nsigma > 0)) {
+        Rcpp::stop("Argument surrogate_nsigma must be positive");
+    }
+
+    // surrogate statespace and initial states
+    RookDirectionalStatespace surrogate_statespace(*statespace, coarsening);
+    std::vector<RookDirectionalStatespace::StateType*> surrogate_states =
+        surrogate_statespace.coarsen_states(
+            *statespace, *initial_latent_state_sample, coarsening
+        );
+    if(surrogate_states.empty()) {
+        Rcpp::stop("Initial latent states have no coarsened counterparts");
+    }
+
+    // observation models are shared by all chains
+    std::vector<std::unique_ptr<AppliedLikelihood>> likelihood_seq =
+        AppliedLikelihoodFamilyFromGPS(eastings, northings, hdops, uere, t, nt);
+
+    // aggregate timepoints for the surrogate
+    std::vector<double> surrogate_eastings, surrogate_northings, 
+        surrogate_hdops;
+    std::vector<std::size_t> surrogate_t;
+    for(std::size_t i = 0; i < t.size(); ++i) {
+        std::size_t tc = t[i] / coarsening;
+        if(surrogate_t.empty() || surrogate_t.back() != tc) {
+            surrogate_t.push_back(tc);
+            surrogate_eastings.push_back(eastings[i]);
+            surrogate_northings.push_back(northings[i]);
+            surrogate_hdops.push_back(hdops[i]);
+        }
+    }
+    std::size_t surrogate_nt = nt == 0 ? 0 : (nt - 1) / coarsening + 1;
+    std::vector<std::unique_ptr<AppliedLikelihood>> surrogate_likelihood_seq =
+        surrogate_nsigma == R_PosInf ? 
+        AppliedLikelihoodFamilyFromGPS(
+            surrogate_eastings, surrogate_northings, surrogate_hdops, uere, 
+            surrogate_t, surrogate_nt
+        ) : 
+        AppliedTruncatedLikelihoodFamilyFromGPS(
+            surrogate_eastings, surrogate_northings, surrogate_hdops, uere, 
+            surrogate_t, surrogate_nt, surrogate_nsigma
+        );
+
+    std::vector<StreamRandom> streams = chain_streams(nchains);
+
+    //
+    // build and run chains
+    //
+
+    std::vector<std::unique_ptr<DelayedAcceptancePmmhChain>> chains;
+    chains.reserve(nchains);
+    for(std::size_t c = 0; c < nchains; ++c) {
+        chains.emplace_back(
+            new DelayedAcceptancePmmhChain(
+                streams[c], *statespace, *initial_latent_state_sample,
+                surrogate_statespace, surrogate_states, likelihood_seq,
+                surrogate_likelihood_seq, delta
+            )
+        );
+    }
+    Rcpp::List res = run_pmmh_chains(
+        chains, parameter_priors, proposal_chol, initial_parameters, niter,
+        nthreads
+    );
+
+    Rcpp::NumericVector screen_pass_rate(nchains);
+    for(std::size_t c = 0; c < nchains; ++c) {
+        screen_pass_rate[c] = chains[c]->nscreened > 0 ?
+            static_cast<double>(chains[c]->npassed) / chains[c]->nscreened : 0;
+    }
+    res["screen_pass_rate"] = screen_pass_rate;
+
+    return res;
+}
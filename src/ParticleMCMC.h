@@ -0,0 +1,397 @@
+/**
+ * Components for particle Markov chain Monte Carlo samplers
+*/
+
+#ifndef MOVECON_PARTICLE_MCMC_H
+#define MOVECON_PARTICLE_MCMC_H
+
+// [[Rcpp::depends(RcppEigen)]]
+
+#include <RcppEigen.h>
+
+#include "Domain.h"
+#include "Directions.h"
+#include "AppliedLikelihood.h"
+#include "ParticleFilter.h"
+#include "TransitionTable.h"
+#include "Random.h"
+
+/**
+ * Prior distribution for a scalar model parameter
+*/
+struct ParameterPrior {
+
+    enum Family { flat, normal, uniform };
+
+    Family family;
+
+    // normal: mean and standard deviation; uniform: lower and upper bounds
+    double a, b;
+
+    /**
+     * Parse a prior specification from R, i.e., list(family = "normal",
+     * mean = 0, sd = 1), list(family = "uniform", min = -1, max = 1), or
+     * list(family = "flat").  Must be called from R's main thread.
+    */
+    static ParameterPrior from_list(Rcpp::List spec);
+
+    double log_density(double x) const;
+
+};
+
+/**
+ * Particle filter approximation to the marginal log-likelihood for a single
+ * MCMC chain.
+ *
+ * Transition rates and probabilities are tabulated by each chain, rather than
+ * cached in the shared statespace, so chains can evaluate the likelihood for
+ * different parameter values from different threads.  The parameter vector
+ * is (directional_persistence, beta).
+*/
+template<typename RandomSource>
+class ChainLikelihood {
+
+    public:
+
+        typedef RookDirectionalStatespace::StateType StateType;
+
+        // evaluates both transition rates and probabilities
+        typedef LazyTransitionTable<CardinalDirectionOrientations>
+            TransitionTableType;
+
+        typedef Particle<
+            StateType,
+            TransitionTableType,
+            TransitionTableType,
+            RandomSource
+        > ParticleType;
+
+        typedef std::vector<std::unique_ptr<AppliedLikelihood>>
+            LikelihoodSeqType;
+        typedef std::vector<NStepProposal<ParticleType>> ProposalSeqType;
+
+        typedef BootstrapParticleFilter<
+            ParticleType,
+            ProposalSeqType,
+            LikelihoodSeqType,
+            NullObserver<ParticleType>,
+            RandomSource
+        > FilterType;
+
+    private:
+
+        std::size_t ncovariates;
+
+        double delta;
+
+        TransitionTableType table;
+
+        ProposalSeqType proposal_seq;
+
+        FilterType filter;
+
+    public:
+
+        /**
+         * @param domain statespace the initial states belong to
+         * @param initial_states initial latent states, one for each particle
+         * @param likelihoods one likelihood for each discrete timepoint, which
+         *   may be shared between chains
+         * @param uniformization uniformization constant for transition rates
+         * @param random_source random numbers for the filter
+         * @param correlated true to run the filter in correlated 
+         *   pseudo-marginal mode
+        */
+        ChainLikelihood(
+            RookDirectionalStatespace & domain,
+            const std::vector<StateType*> & initial_states,
+            LikelihoodSeqType & likelihoods, double uniformization,
+            RandomSource & random_source, bool correlated = false
+        ) : ncovariates(initial_states.front()->properties.location->x.size()),
+            delta(uniformization), table(domain),
+            proposal_seq(
+                ConstantStepFamily<ParticleType>(likelihoods.size(), 1)
+            ),
+            filter(std::vector<ParticleType>()) {
+
+            // particles read transition distributions from the table, which 
+            // is updated in place for each new parameter value
+            std::vector<ParticleType> & particles = filter.initial_particles();
+            particles.reserve(initial_states.size());
+            ParticleType particle(table, table, random_source);
+            for(auto state : initial_states) {
+                particle.state = state;
+                particles.push_back(particle);
+            }
+
+            filter.proposal_distributions = &proposal_seq;
+            filter.likelihoods = &likelihoods;
+            filter.random_source = &random_source;
+            filter.correlated = correlated;
+        }
+
+        ChainLikelihood(const ChainLikelihood &) = delete;
+        ChainLikelihood & operator=(const ChainLikelihood &) = delete;
+
+        std::size_t nparams() const { return ncovariates + 1; }
+
+        /**
+         * Number of auxiliary random variables in each block the filter uses
+         * in correlated mode, which covers the draws for the longest 
+         * proposal, and the uniform used for resampling
+        */
+        std::size_t auxiliary_block_size() const {
+            std::size_t block_size = 1;
+            for(auto & proposal : proposal_seq) {
+                block_size = std::max(block_size, proposal.max_draws());
+            }
+            return block_size;
+        }
+
+        /**
+         * Number of auxiliary random variables the filter uses in correlated
+         * mode, with one block for each particle and one block for 
+         * resampling at each timepoint
+        */
+        std::size_t nauxiliary() {
+            return proposal_seq.size() * 
+                (filter.initial_particles().size() + 1) * 
+                auxiliary_block_size();
+        }
+
+        /**
+         * Particle filter approximation to the marginal log-likelihood
+         *
+         * @param threshold returns R_NegInf as soon as the log-likelihood is
+         *   certain to end below threshold, i.e., for MH proposals that will
+         *   be rejected
+        */
+        double loglik(
+            const Eigen::VectorXd & theta, double threshold = R_NegInf
+        ) {
+            table.set_parameters(theta(0), theta.tail(ncovariates), delta);
+            filter.termination_threshold = threshold;
+            double ll = filter.marginal_ll();
+            return filter.truncated() ? R_NegInf : ll;
+        }
+
+};
+
+/**
+ * PMMH chain whose filter draws new random numbers for each likelihood
+ * evaluation
+*/
+class IndependentPmmhChain {
+
+    public:
+
+        StreamRandom rng;
+
+        ChainLikelihood<StreamRandom> target;
+
+        IndependentPmmhChain(
+            const StreamRandom & stream, RookDirectionalStatespace & domain,
+            const std::vector<RookDirectionalStatespace::StateType*> & states,
+            ChainLikelihood<StreamRandom>::LikelihoodSeqType & likelihoods,
+            double delta
+        ) : rng(stream), target(domain, states, likelihoods, delta, rng) { }
+
+        double loglik_current(const Eigen::VectorXd & theta) {
+            return target.loglik(theta);
+        }
+
+        double loglik_proposal(
+            const Eigen::VectorXd & theta, double threshold
+        ) {
+            return target.loglik(theta, threshold);
+        }
+
+        double screen(const Eigen::VectorXd & theta, double log_prior_ratio) {
+            return 0;
+        }
+
+        void accept() { }
+
+};
+
+/**
+ * Correlated PMMH chain (Deligiannidis et. al., 2018, doi: 10.1111/rssb.12280)
+ * whose filter derives its random numbers from auxiliary standard normal
+ * variables.  Each proposal perturbs the auxiliary variables u via the 
+ * Crank-Nicolson update u' = rho u + sqrt(1 - rho^2) e, with e ~ N(0, I), 
+ * which leaves N(0, I) invariant.  The MH ratio for the joint proposal of the
+ * parameters and auxiliary variables therefore matches the ratio for 
+ * standard PMMH.
+*/
+class CorrelatedPmmhChain {
+
+    public:
+
+        StreamRandom rng;
+
+        AuxiliaryRandom auxiliary;
+
+        ChainLikelihood<AuxiliaryRandom> target;
+
+    private:
+
+        std::vector<double> current;
+
+        double rho;
+
+    public:
+
+        /**
+         * @param correlation Crank-Nicolson correlation rho, in [0, 1)
+        */
+        CorrelatedPmmhChain(
+            const StreamRandom & stream, RookDirectionalStatespace & domain,
+            const std::vector<RookDirectionalStatespace::StateType*> & states,
+            ChainLikelihood<AuxiliaryRandom>::LikelihoodSeqType & likelihoods,
+            double delta, double correlation
+        ) : rng(stream), 
+            target(domain, states, likelihoods, delta, auxiliary, true),
+            rho(correlation) {
+            // size blocks from the filter's proposals, once they exist
+            auxiliary = AuxiliaryRandom(
+                target.nauxiliary(), target.auxiliary_block_size()
+            );
+            current.resize(auxiliary.values().size());
+            for(auto & u : current) {
+                u = rng.rnorm();
+            }
+            auxiliary.values() = current;
+        }
+
+        double loglik_current(const Eigen::VectorXd & theta) {
+            auxiliary.values() = current;
+            return target.loglik(theta);
+        }
+
+        double loglik_proposal(
+            const Eigen::VectorXd & theta, double threshold
+        ) {
+            std::vector<double> & proposal = auxiliary.values();
+            double scale = std::sqrt(1 - rho * rho);
+            for(std::size_t i = 0; i < current.size(); ++i) {
+                proposal[i] = rho * current[i] + scale * rng.rnorm();
+            }
+            return target.loglik(theta, threshold);
+        }
+
+        double screen(const Eigen::VectorXd & theta, double log_prior_ratio) {
+            return 0;
+        }
+
+        void accept() {
+            current.swap(auxiliary.values());
+        }
+
+};
+
+/**
+ * Delayed-acceptance PMMH chain (Christen and Fox, 2005, doi: 
+ * 10.1198/106186005X76983) that screens proposals with a particle filter on a
+ * coarsened copy of the statespace before running the filter on the original
+ * statespace.
+ * 
+ * Proposals pass the screen with probability min(1, r1), in which r1 is the 
+ * MH ratio computed with the surrogate likelihood.  Proposals that pass are 
+ * accepted with probability min(1, r2), in which r2 is the standard MH ratio
+ * divided by r1.  The surrogate estimate for the current parameters is 
+ * retained with the chain's state, as for the estimate from the original 
+ * statespace.  The surrogate filter can die out where the original filter
+ * does not, i.e., on coarse grids, so r1 is set to 1 if either surrogate 
+ * estimate is zero, which reduces the test to the standard MH step.  The 
+ * first-stage ratios for moving between two states in either direction are 
+ * therefore always reciprocals, so the chain targets the same posterior as 
+ * standard PMMH.
+*/
+class DelayedAcceptancePmmhChain {
+
+    public:
+
+        StreamRandom rng;
+
+        ChainLikelihood<StreamRandom> target;
+
+        ChainLikelihood<StreamRandom> surrogate;
+
+        // number of proposals screened, and number that passed the screen
+        std::size_t nscreened, npassed;
+
+    private:
+
+        double surrogate_current, surrogate_proposal;
+
+    public:
+
+        /**
+         * @param surrogate_domain coarsened statespace
+         * @param surrogate_states initial states for the surrogate, mapped
+         *   onto surrogate_domain
+         * @param surrogate_likelihoods one likelihood for each of the 
+         *   surrogate's discrete timepoints
+        */
+        DelayedAcceptancePmmhChain(
+            const StreamRandom & stream, RookDirectionalStatespace & domain,
+            const std::vector<RookDirectionalStatespace::StateType*> & states,
+            RookDirectionalStatespace & surrogate_domain,
+            const std::vector<RookDirectionalStatespace::StateType*> & 
+                surrogate_states,
+            ChainLikelihood<StreamRandom>::LikelihoodSeqType & likelihoods,
+            ChainLikelihood<StreamRandom>::LikelihoodSeqType & 
+                surrogate_likelihoods,
+            double delta
+        ) : rng(stream), target(domain, states, likelihoods, delta, rng),
+            surrogate(
+                surrogate_domain, surrogate_states, surrogate_likelihoods, 
+                delta, rng
+            ),
+            nscreened(0), npassed(0), surrogate_current(R_NegInf),
+            surrogate_proposal(R_NegInf) { }
+
+        double loglik_current(const Eigen::VectorXd & theta) {
+            surrogate_current = surrogate.loglik(theta);
+            return target.loglik(theta);
+        }
+
+        double loglik_proposal(
+            const Eigen::VectorXd & theta, double threshold
+        ) {
+            return target.loglik(theta, threshold);
+        }
+
+        /**
+         * First stage of the delayed-acceptance test.  Returns the log of the
+         * surrogate MH ratio r1 if the proposal passes the screen, or R_NegInf 
+         * otherwise.  Proposals bypass the screen, with r1 = 1, if the 
+         * surrogate likelihood for the current or proposed parameters is 
+         * zero.
+        */
+        double screen(const Eigen::VectorXd & theta, double log_prior_ratio) {
+            ++nscreened;
+            surrogate_proposal = surrogate.loglik(theta);
+            if(
+                surrogate_current == R_NegInf || 
+                surrogate_proposal == R_NegInf
+            ) {
+                ++npassed;
+                return 0;
+            }
+            double log_ratio = 
+                surrogate_proposal - surrogate_current + log_prior_ratio;
+            if(!(std::log(rng.runif()) < log_ratio)) {
+                return R_NegInf;
+            }
+            ++npassed;
+            return log_ratio;
+        }
+
+        void accept() {
+            surrogate_current = surrogate_proposal;
+        }
+
+};
+
+#endif
@@ -0,0 +1,227 @@
+#include "ParticleTuning.h"
+#include "ThreadPool.h"
+
+ParticleCountTuner::ParticleCountTuner(
+    Rcpp::XPtr<RookDirectionalStatespace> domain,
+    Rcpp::XPtr<RookDirectionalStatespaceSearch> domain_search,
+    LikelihoodSeqType && likelihoods, double easting, double northing,
+    double hdop, double gps_uere, double target, std::size_t replicates,
+    std::size_t initial_particles, std::size_t particle_limit
+) : statespace(domain), search(domain_search),
+    likelihood_seq(std::move(likelihoods)), initial_easting(easting),
+    initial_northing(northing), initial_hdop(hdop), uere(gps_uere),
+    target_variance(target), nreplicates(replicates),
+    max_particles(particle_limit), max_pilots(5),
+    particles(initial_particles) {
+
+    if(statespace->states.empty()) {
+        Rcpp::stop("Argument statespace must not be empty");
+    }
+    if(!(target_variance > 0)) {
+        Rcpp::stop("Argument target_variance must be positive");
+    }
+    if(nreplicates < 2) {
+        Rcpp::stop("Argument nreplicates must be at least 2");
+    }
+    if(particles == 0 || max_particles < particles) {
+        Rcpp::stop(
+            "Argument initial_particles must be positive and at most "
+            "max_particles"
+        );
+    }
+}
+
+double ParticleCountTuner::pilot_variance(
+    std::size_t M, const Eigen::VectorXd & theta, double delta,
+    std::size_t nthreads
+) {
+
+    // draw initial latent states and random number streams on the main thread
+    std::vector<Rcpp::XPtr<std::vector<StateType*>>> samples;
+    samples.reserve(nreplicates);
+    for(std::size_t i = 0; i < nreplicates; ++i) {
+        Rcpp::List sample = initial_sample(M);
+        samples.push_back(sample["states_cpp"]);
+    }
+    std::vector<StreamRandom> streams;
+    streams.reserve(nreplicates);
+    streams.push_back(StreamRandom::from_r());
+    for(std::size_t i = 1; i < nreplicates; ++i) {
+        streams.push_back(streams.back().split());
+    }
+
+    // run the replicate filters in parallel
+    std::vector<double> ll(nreplicates);
+    auto run_replicate = [&](std::size_t i) {
+        ChainLikelihood<StreamRandom> target(
+            *statespace, *samples[i], likelihood_seq, delta, streams[i]
+        );
+        ll[i] = target.loglik(theta);
+    };
+    WorkStealingPool pool(nthreads);
+    pool.run(std::vector<double>(nreplicates, 1), run_replicate);
+
+    // sample variance, which is infinite if any filter degenerates
+    double mean = 0;
+    for(double x : ll) {
+        if(x == R_NegInf) {
+            return R_PosInf;
+        }
+        mean += x;
+    }
+    mean /= nreplicates;
+    double variance = 0;
+    for(double x : ll) {
+        variance += (x - mean) * (x - mean);
+    }
+    return variance / (nreplicates - 1);
+}
+
+std::size_t ParticleCountTuner::tune(
+    const Eigen::VectorXd & theta, double delta, std::size_t nthreads,
+    std::vector<Pilot> & pilots
+) {
+
+    std::size_t npar =
+        statespace->states.begin()->second.properties.location->x.size() + 1;
+    if(static_cast<std::size_t>(theta.size()) != npar) {
+        Rcpp::stop("Argument beta has the wrong length");
+    }
+
+    pilots.clear();
+    std::size_t M = particles;
+
+    // pooled estimate of the variance for a single particle, from the pilots
+    // whose filters did not degenerate
+    double scaled_variance = 0;
+    std::size_t nfinite = 0;
+
+    for(std::size_t i = 0; i < max_pilots; ++i) {
+
+        double variance = pilot_variance(M, theta, delta, nthreads);
+        pilots.push_back(Pilot{M, variance});
+
+        // variance is roughly proportional to 1/M, or grow M quickly if the
+        // filters degenerated
+        std::size_t next = max_particles;
+        if(variance != R_PosInf) {
+            scaled_variance += variance * M;
+            ++nfinite;
+            double M_target = 
+                std::ceil(scaled_variance / nfinite / target_variance);
+            if(M_target < max_particles) {
+                next = std::max<std::size_t>(M_target, 1);
+            }
+        } else if(M < max_particles / 2) {
+            next = 2 * M;
+        }
+
+        // stop once the trial value stabilizes
+        bool stable = variance != R_PosInf &&
+            10 * std::max(next, M) <= 11 * std::min(next, M);
+        bool limited = next == max_particles && M == max_particles;
+        M = next;
+        if(stable || limited) {
+            break;
+        }
+    }
+
+    particles = M;
+    return M;
+}
+
+/**
+ * Build a tool that chooses the number of particles for GPS observations,
+ * such that the variance of the particle filter's log-likelihood estimator
+ * reaches a target
+ *
+ * Initial latent states are drawn via
+ * \code{sample_gaussian_states_from_hdop_uere}, centered on the first
+ * observation.
+ *
+ * @param t vector of discrete time indices (starting at 0) at which
+ *   observations are available
+ * @param nt total number of discrete timepoints
+ * @param statespace Object constructed from \code{build_statespace}
+ * @param statespace_search Object constructed from
+ *   \code{build_statespace_search} for statespace
+ * @param target_variance target variance for the log-likelihood estimator;
+ *   values between 1 and 2 balance PMMH mixing against the cost of each
+ *   iteration
+ * @param nreplicates number of filters to run for each pilot estimate of the
+ *   variance
+ * @param initial_particles number of particles for the first pilot run
+ * @param max_particles largest number of particles to consider
+*/
+// [[Rcpp::export]]
+Rcpp::XPtr<ParticleCountTuner> build_particle_count_tuner_from_gps(
+    /* likelihood components */
+    std::vector<double> eastings, std::vector<double> northings,
+    std::vector<double> hdops, double uere, std::vector<std::size_t> t,
+    std::size_t nt,
+    /* filter components */
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::XPtr<RookDirectionalStatespaceSearch> statespace_search,
+    /* tuning components */
+    double target_variance = 1, std::size_t nreplicates = 20,
+    std::size_t initial_particles = 100, std::size_t max_particles = 1e5
+) {
+    if(eastings.empty()) {
+        Rcpp::stop("At least one observation is required");
+    }
+    ParticleCountTuner * tuner = new ParticleCountTuner(
+        statespace, statespace_search,
+        AppliedLikelihoodFamilyFromGPS(
+            eastings, northings, hdops, uere, t, nt
+        ),
+        eastings.front(), northings.front(), hdops.front(), uere,
+        target_variance, nreplicates, initial_particles, max_particles
+    );
+    return Rcpp::XPtr<ParticleCountTuner>(tuner, true);
+}
+
+/**
+ * Choose the number of particles for a set of model parameters, using a tool
+ * built by \code{build_particle_count_tuner_from_gps}
+ *
+ * Tuners start from their most recent choice, so calling this function again
+ * as parameters drift, i.e., between batches of MCMC iterations, re-tunes
+ * the number of particles with little extra work.  Re-tuning within a chain
+ * is a form of adaptive MCMC, so the number of particles should be fixed
+ * once burn-in ends.
+ *
+ * @param nthreads number of threads to use for the pilot filters
+ * @return list with the chosen number of particles, the numbers of particles
+ *   and variance estimates for each pilot run, and an initial latent state
+ *   sample with the chosen number of particles, i.e., from
+ *   \code{sample_gaussian_states_from_hdop_uere}
+*/
+// [[Rcpp::export]]
+Rcpp::List tune_particle_count(
+    Rcpp::XPtr<ParticleCountTuner> tuner,
+    /* model parameters */
+    double directional_persistence, Eigen::VectorXd beta, double delta,
+    std::size_t nthreads = 1
+) {
+
+    Eigen::VectorXd theta(beta.size() + 1);
+    theta(0) = directional_persistence;
+    theta.tail(beta.size()) = beta;
+
+    std::vector<ParticleCountTuner::Pilot> pilots;
+    std::size_t M = tuner->tune(theta, delta, nthreads, pilots);
+
+    Rcpp::NumericVector pilot_particles(pilots.size());
+    Rcpp::NumericVector pilot_variance(pilots.size());
+    for(std::size_t i = 0; i < pilots.size(); ++i) {
+        pilot_particles[i] = pilots[i].particles;
+        pilot_variance[i] = pilots[i].variance;
+    }
+
+    return Rcpp::List::create(
+        Rcpp::Named("particles") = M,
+        Rcpp::Named("pilot_particles") = pilot_particles,
+        Rcpp::Named("pilot_variance") = pilot_variance,
+        Rcpp::Named("initial_latent_state_sample") = tuner->initial_sample(M)
+    );
+}
@@ -0,0 +1,124 @@
+/**
+ * Tools to choose the number of particles for particle filters
+*/
+
+#ifndef MOVECON_PARTICLE_TUNING_H
+#define MOVECON_PARTICLE_TUNING_H
+
+// [[Rcpp::depends(RcppEigen)]]
+
+#include <RcppEigen.h>
+
+#include "Domain.h"
+#include "DomainSearch.h"
+#include "ParticleMCMC.h"
+
+/**
+ * Choose the smallest number of particles M for which the variance of the
+ * particle filter's log-likelihood estimator reaches a target, i.e., a
+ * variance of about 1 to 2 for PMMH (Doucet et. al., 2015, doi:
+ * 10.1093/biomet/asu075).
+ *
+ * Pilot filters estimate the variance at a trial value of M, with a new
+ * initial latent state sample for each replicate.  The variance is roughly
+ * proportional to 1/M, so the pilots are pooled to estimate the variance for
+ * a single particle, which yields the next trial value.  Tuning stops once
+ * the trial value stabilizes.  Tuners remember their most recent choice, so
+ * re-tuning for nearby parameters, i.e., as a sampler's parameters drift,
+ * needs few pilots.
+*/
+class ParticleCountTuner {
+
+    public:
+
+        typedef RookDirectionalStatespace::StateType StateType;
+
+        typedef ChainLikelihood<StreamRandom>::LikelihoodSeqType
+            LikelihoodSeqType;
+
+        /**
+         * Log-likelihood variance estimated by a pilot run
+        */
+        struct Pilot {
+            std::size_t particles;
+            double variance;
+        };
+
+    private:
+
+        Rcpp::XPtr<RookDirectionalStatespace> statespace;
+        Rcpp::XPtr<RookDirectionalStatespaceSearch> search;
+
+        LikelihoodSeqType likelihood_seq;
+
+        // distribution for initial latent states
+        double initial_easting, initial_northing, initial_hdop, uere;
+
+        double target_variance;
+        std::size_t nreplicates;
+        std::size_t max_particles;
+        std::size_t max_pilots;
+
+        // most recent choice, which seeds the next tuning run
+        std::size_t particles;
+
+        /**
+         * Estimate the log-likelihood variance for M particles
+        */
+        double pilot_variance(
+            std::size_t M, const Eigen::VectorXd & theta, double delta,
+            std::size_t nthreads
+        );
+
+    public:
+
+        /**
+         * @param domain statespace for the filters
+         * @param domain_search search structure for domain, used to sample
+         *   initial latent states
+         * @param likelihoods one likelihood for each discrete timepoint
+         * @param easting,northing,hdop,gps_uere parameters for the Gaussian
+         *   initial latent state distribution
+         * @param target target variance for the log-likelihood estimator
+         * @param replicates number of filters in each pilot run
+         * @param initial_particles number of particles for the first pilot
+         * @param particle_limit largest number of particles to consider
+        */
+        ParticleCountTuner(
+            Rcpp::XPtr<RookDirectionalStatespace> domain,
+            Rcpp::XPtr<RookDirectionalStatespaceSearch> domain_search,
+            LikelihoodSeqType && likelihoods, double easting,
+            double northing, double hdop, double gps_uere, double target,
+            std::size_t replicates, std::size_t initial_particles,
+            std::size_t particle_limit
+        );
+
+        ParticleCountTuner(const ParticleCountTuner &) = delete;
+        ParticleCountTuner & operator=(const ParticleCountTuner &) = delete;
+
+        /**
+         * Choose the number of particles for model parameters theta, i.e.,
+         * (directional_persistence, beta).  Must be called from R's main
+         * thread, which draws the initial latent states and seeds the
+         * pilots' random number streams.
+         *
+         * @param pilots output for the pilot runs' variance estimates
+        */
+        std::size_t tune(
+            const Eigen::VectorXd & theta, double delta, std::size_t nthreads,
+            std::vector<Pilot> & pilots
+        );
+
+        /**
+         * Draw an initial latent state sample with M states
+        */
+        Rcpp::List initial_sample(std::size_t M) {
+            return sample_gaussian_states_from_hdop_uere(
+                search, initial_easting, initial_northing, initial_hdop, uere,
+                M
+            );
+        }
+
+};
+
+#endif
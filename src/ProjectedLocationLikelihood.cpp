@@ -1,5 +1,6 @@
 #include "ProjectedLocationLikelihood.h"
 #include "DomainSearch.h"
+#include "Random.h"
 
 /**
  * Create a family of location observation distributions from ellipse vectors
@@ -91,13 +92,9 @@ Rcpp::List sample_gaussian_states(
             r_easting, r_northing
         );
         // randomly select a state at location
-        std::set<StateType*> r_states_set = 
-            statespace_search->states_by_location[r_location];
-        std::size_t r_ind = std::floor(R::runif(0, r_states_set.size()));
-        auto set_iter = r_states_set.begin();
-        for(std::size_t j = 0; j < r_ind; ++j) 
-            ++set_iter;
-        StateType* r_state = *set_iter;
+        StateType* r_state = statespace_search->sample_state_at(
+            r_location, R::runif(0, 1)
+        );
         // export sample
         states->push_back(r_state);
         // states_formatted.push_back(format_state(*r_state));
@@ -111,6 +108,79 @@ Rcpp::List sample_gaussian_states(
     );
 }
 
+/**
+ * Sample states from a Gaussian distribution discretized over the locations 
+ * within its nsigma-contour, i.e., each location's probability is 
+ * proportional to the density at the location, and with last movement 
+ * directions uniformly sampled.  Draws from the location nearest the 
+ * distribution's center if no locations lie within the contour.
+*/
+Rcpp::List sample_discretized_gaussian_states(
+    Rcpp::XPtr<RookDirectionalStatespaceSearch> statespace_search, 
+    const ProjectedLocationLikelihood & distribution,
+    double nsigma,
+    std::size_t n
+) {
+
+    typedef RookDirectionalStatespace::StateType StateType;
+
+    //
+    // discretize distribution
+    //
+
+    std::vector<Location*> locations;
+    statespace_search->map_ellipse(
+        distribution, nsigma, std::back_inserter(locations)
+    );
+    if(locations.empty()) {
+        double easting, northing;
+        distribution.center(easting, northing);
+        locations.push_back(statespace_search->map_location(easting, northing));
+    }
+
+    // split each location's mass evenly between its states, using weights 
+    // relative to the maximum density to avoid underflow
+    std::vector<StateType*> support;
+    std::vector<double> weights;
+    for(auto location : locations) {
+        auto location_states = statespace_search->states_at(location);
+        double w = std::exp(
+            distribution.dlocation(location->easting, location->northing) - 
+            distribution.log_max_density()
+        ) / location_states.size();
+        for(auto state : location_states) {
+            support.push_back(state);
+            weights.push_back(w);
+        }
+    }
+
+    // fall back to uniform weights if all densities underflow
+    if(std::none_of(weights.begin(), weights.end(), 
+        [](double w) { return w > 0; })) {
+        std::fill(weights.begin(), weights.end(), 1);
+    }
+
+    //
+    // sample states
+    //
+
+    AliasTable table(weights);
+    RRandom rng;
+
+    std::vector<StateType*> * states = new std::vector<StateType*>();
+    states->reserve(n);
+    for(std::size_t i = 0; i < n; ++i) {
+        states->push_back(support[table.sample(rng)]);
+    }
+
+    // package results
+    Rcpp::XPtr<std::vector<StateType*>> state_ptr(states, true);
+    return Rcpp::List::create(
+        Rcpp::Named("states") = Rcpp::List::create(),
+        Rcpp::Named("states_cpp") = state_ptr
+    );
+}
+
 /**
  * Sample states from a Gaussian distribution constrained to a spatial domain,
  * and with last movement directions uniformly sampled
@@ -159,3 +229,56 @@ Rcpp::List sample_gaussian_states_from_hdop_uere(
         statespace_search, sampler, n
     );
 }
+
+/**
+ * Sample states from a Gaussian distribution discretized over the locations
+ * within its nsigma-contour, and with last movement directions uniformly 
+ * sampled
+*/
+// [[Rcpp::export]]
+Rcpp::List sample_discretized_gaussian_states(
+    Rcpp::XPtr<RookDirectionalStatespaceSearch> statespace_search, 
+    double easting,
+    double northing,
+    double semi_major,
+    double semi_minor,
+    double orientation,
+    std::size_t n,
+    double nsigma = 3
+) {
+    
+    ProjectedLocationLikelihood distribution = 
+        ProjectedLocationLikelihood::from_ellipse(
+            easting, northing, semi_major, semi_minor, orientation
+        );
+
+    return sample_discretized_gaussian_states(
+        statespace_search, distribution, nsigma, n
+    );
+}
+
+/**
+ * Sample states from a Gaussian distribution discretized over the locations
+ * within its nsigma-contour, and with last movement directions uniformly 
+ * sampled
+*/
+// [[Rcpp::export]]
+Rcpp::List sample_discretized_gaussian_states_from_hdop_uere(
+    Rcpp::XPtr<RookDirectionalStatespaceSearch> statespace_search, 
+    double easting,
+    double northing,
+    double hdop, 
+    double uere,
+    std::size_t n,
+    double nsigma = 3
+) {
+
+    ProjectedLocationLikelihood distribution = 
+        ProjectedLocationLikelihood::from_hdop_uere(
+            easting, northing, hdop, uere
+        );
+
+    return sample_discretized_gaussian_states(
+        statespace_search, distribution, nsigma, n
+    );
+}
@@ -71,6 +71,20 @@ struct ProjectedLocationLikelihood {
             );
         }
 
+        /**
+         * Build the distribution of the same observation after adding 
+         * independent, isotropic noise with the given variance to each 
+         * coordinate
+        */
+        ProjectedLocationLikelihood inflate(double variance) const {
+            double sd_e = std::sqrt(sd_easting * sd_easting + variance);
+            double sd_n = std::sqrt(sd_northing * sd_northing + variance);
+            return ProjectedLocationLikelihood(
+                mu_easting, mu_northing, sd_e, sd_n, 
+                rho * sd_easting * sd_northing / sd_e / sd_n
+            );
+        }
+
         /**
          * Evaluate log-likelihood for a state
         */
@@ -98,6 +112,39 @@ struct ProjectedLocationLikelihood {
             return - q / 2 / rhosq_c + lcst;
        }
 
+        /**
+         * Write the distribution's center to output parameters
+        */
+        void center(double & easting, double & northing) const {
+            easting = mu_easting;
+            northing = mu_northing;
+        }
+
+        /**
+         * Squared Mahalanobis distance between coordinates and the 
+         * distribution's center
+        */
+        double mahalanobis2(double easting, double northing) const {
+            double zx = (easting - mu_easting) / sd_easting;
+            double zy = (northing - mu_northing) / sd_northing;
+            return (zx * zx - 2 * rho * zx * zy + zy * zy) / rhosq_c;
+        }
+
+        /**
+         * Evaluate the log-density at coordinates
+        */
+        double dlocation(double easting, double northing) const {
+            return - mahalanobis2(easting, northing) / 2 + lcst;
+        }
+
+        /**
+         * Log-likelihood at the distribution's center, which bounds the 
+         * log-likelihood for all states
+        */
+        double log_max_density() const {
+            return lcst;
+        }
+
         /**
          * Evaluate log-likelihood for a particle
         */
@@ -106,6 +153,34 @@ struct ProjectedLocationLikelihood {
             return dstate(*particle.state);
         }
 
+        /**
+         * Determine if a state lies within the nsigma-contour of the 
+         * distribution, i.e., if the squared Mahalanobis distance between the 
+         * state's location and the distribution's center is at most nsigma^2
+        */
+        template<typename State>
+        bool within(const State & state, double nsigma) const {
+            return mahalanobis2(
+                state.properties.location->easting, 
+                state.properties.location->northing
+            ) <= nsigma * nsigma;
+        }
+
+        /**
+         * Compute the axis-aligned bounding box for the nsigma-contour of the 
+         * distribution, using output parameters to write directly to 
+         * pre-allocated memory
+        */
+        void bounding_box(
+            double nsigma, double & min_easting, double & min_northing, 
+            double & max_easting, double & max_northing
+        ) const {
+            min_easting = mu_easting - nsigma * sd_easting;
+            max_easting = mu_easting + nsigma * sd_easting;
+            min_northing = mu_northing - nsigma * sd_northing;
+            max_northing = mu_northing + nsigma * sd_northing;
+        }
+
         /**
          * Draw a sample from the parameterized distribution, using output 
          * parameters to write directly to pre-allocated memory
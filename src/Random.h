@@ -0,0 +1,408 @@
+/**
+ * Sources of random numbers for simulation and filtering.
+ *
+ * RRandom draws from R's random number generator, so it may only be used from
+ * R's main thread.  StreamRandom objects own independent streams of random
+ * numbers that may be used concurrently from different threads.
+ * AuxiliaryRandom objects derive random numbers from a caller-supplied vector.
+ * AliasTable objects draw from discrete distributions given any source.
+*/
+
+#ifndef MOVECON_RANDOM_H
+#define MOVECON_RANDOM_H
+
+#include <Rcpp.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+struct RRandom {
+
+    double runif() { return R::unif_rand(); }
+
+    double rexp() { return R::exp_rand(); }
+
+    double rnorm() { return R::norm_rand(); }
+
+    std::size_t rbinom(std::size_t n, double p) {
+        return static_cast<std::size_t>(R::rbinom(n, p));
+    }
+
+};
+
+/**
+ * xoshiro256** generator (Blackman and Vigna, 2021, doi: 10.1145/3460772),
+ * which can jump ahead 2^128 draws to create non-overlapping streams
+*/
+class Xoshiro256 {
+
+    private:
+
+        std::array<std::uint64_t, 4> s;
+
+        static std::uint64_t rotl(std::uint64_t x, int k) {
+            return (x << k) | (x >> (64 - k));
+        }
+
+    public:
+
+        typedef std::uint64_t result_type;
+
+        static constexpr result_type min() { return 0; }
+
+        static constexpr result_type max() {
+            return std::numeric_limits<result_type>::max();
+        }
+
+        /**
+         * Initialize the state via splitmix64, as recommended by the authors
+        */
+        explicit Xoshiro256(std::uint64_t seed = 0) {
+            for(auto & x : s) {
+                std::uint64_t z = (seed += 0x9e3779b97f4a7c15);
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+                x = z ^ (z >> 31);
+            }
+        }
+
+        result_type operator()() {
+            const std::uint64_t result = rotl(s[1] * 5, 7) * 9;
+            const std::uint64_t t = s[1] << 17;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl(s[3], 45);
+            return result;
+        }
+
+        /**
+         * Advance the state by 2^128 draws
+        */
+        void jump() {
+            static const std::uint64_t JUMP[] = {
+                0x180ec6d33cfd0aba, 0xd5a61266f0c9392c,
+                0xa9582618e03fc9aa, 0x39abdc4529b1661c
+            };
+            std::array<std::uint64_t, 4> t = {0, 0, 0, 0};
+            for(auto jump : JUMP) {
+                for(int b = 0; b < 64; ++b) {
+                    if(jump & (UINT64_C(1) << b)) {
+                        for(int i = 0; i < 4; ++i) {
+                            t[i] ^= s[i];
+                        }
+                    }
+                    (*this)();
+                }
+            }
+            s = t;
+        }
+
+        const std::array<std::uint64_t, 4> & state() const { return s; }
+
+        void set_state(const std::array<std::uint64_t, 4> & x) { s = x; }
+
+};
+
+/**
+ * Independent stream of random numbers
+*/
+class StreamRandom {
+
+    private:
+
+        Xoshiro256 engine;
+
+    public:
+
+        explicit StreamRandom(std::uint64_t seed = 0) : engine(seed) { }
+
+        /**
+         * Create a stream that begins 2^128 draws after this stream's current
+         * position, i.e., to give each thread or task its own stream
+        */
+        StreamRandom split() const {
+            StreamRandom res(*this);
+            res.engine.jump();
+            return res;
+        }
+
+        double runif() {
+            // uniform on [0, 1) with 53 bits of precision
+            return (engine() >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        double rexp() {
+            return -std::log1p(-runif());
+        }
+
+        double rnorm() {
+            return std::normal_distribution<double>()(engine);
+        }
+
+        std::size_t rbinom(std::size_t n, double p) {
+            return std::binomial_distribution<std::size_t>(n, p)(engine);
+        }
+
+        Xoshiro256 & generator() { return engine; }
+
+        const Xoshiro256 & generator() const { return engine; }
+
+        /**
+         * Create a stream seeded from R's random number generator, so that
+         * streams are reproducible via set.seed().  Must be called from R's
+         * main thread.
+        */
+        static StreamRandom from_r() {
+            return StreamRandom(seed_from_r());
+        }
+
+        /**
+         * Draw a 64-bit seed from R's random number generator.  Must be 
+         * called from R's main thread.
+        */
+        static std::uint64_t seed_from_r() {
+            std::uint64_t seed = static_cast<std::uint64_t>(
+                R::unif_rand() * 4294967296.0
+            );
+            return (seed << 32) ^ static_cast<std::uint64_t>(
+                R::unif_rand() * 4294967296.0
+            );
+        }
+
+};
+
+/**
+ * Stream of random numbers divided into blocks that seek() can move to 
+ * directly, i.e., so that filters whose streams share a seed use the same 
+ * random numbers for each particle and timepoint even though their particles
+ * use different numbers of random draws.  Each block restarts the generator 
+ * from its own seed, which is derived from the stream's seed and the block's 
+ * index.
+*/
+class BlockStreamRandom : public StreamRandom {
+
+    private:
+
+        std::uint64_t stream_seed;
+
+    public:
+
+        explicit BlockStreamRandom(std::uint64_t seed = 0) : 
+            StreamRandom(seed), stream_seed(seed) { }
+
+        void seek(std::size_t block) {
+            // Xoshiro256 seeds its four words with consecutive splitmix64 
+            // outputs, so offsetting seeds by four increments gives each 
+            // block distinct words
+            generator() = Xoshiro256(
+                stream_seed + 4 * (block + 1) * UINT64_C(0x9e3779b97f4a7c15)
+            );
+        }
+
+        /**
+         * Create a stream seeded from R's random number generator.  Must be 
+         * called from R's main thread.
+        */
+        static BlockStreamRandom from_r() {
+            return BlockStreamRandom(seed_from_r());
+        }
+
+};
+
+/**
+ * Random numbers derived from an explicit vector of standard normal auxiliary
+ * variables, i.e., for correlated pseudo-marginal methods (Deligiannidis et.
+ * al., 2018, doi: 10.1111/rssb.12280) that perturb the auxiliary variables
+ * rather than drawing new random numbers for each likelihood evaluation.
+ *
+ * The vector is divided into blocks of equal size, and seek() moves to the
+ * start of a block.  Giving each particle its own block at each timepoint
+ * keeps the map from auxiliary variables to particle trajectories stable even
+ * though particles use different numbers of random draws.  Blocks must be
+ * large enough for all of a particle's draws, so drawing past the end of a
+ * block, or seeking past the end of the vector, throws std::out_of_range
+ * rather than reusing variables.
+*/
+class AuxiliaryRandom {
+
+    private:
+
+        std::vector<double> u;
+        std::size_t block_size;
+        std::size_t pos;
+
+        // end of the current block, or of the vector before the first seek
+        std::size_t block_end;
+
+        double next() {
+            if(pos >= block_end) {
+                throw std::out_of_range(
+                    "Random draws exceed the block of auxiliary variables"
+                );
+            }
+            return u[pos++];
+        }
+
+    public:
+
+        /**
+         * @param n number of auxiliary variables
+         * @param block number of auxiliary variables in each block
+        */
+        explicit AuxiliaryRandom(std::size_t n = 1, std::size_t block = 1) :
+            u(std::max<std::size_t>(n, 1), 0), block_size(block), pos(0),
+            block_end(u.size()) { }
+
+        /**
+         * Auxiliary variables, which may be updated in place
+        */
+        std::vector<double> & values() { return u; }
+
+        void seek(std::size_t block) {
+            pos = block * block_size;
+            block_end = pos + block_size;
+            if(block_end > u.size()) {
+                throw std::out_of_range(
+                    "Block lies outside the vector of auxiliary variables"
+                );
+            }
+        }
+
+        double runif() {
+            // standard normal cdf, kept below 1 so draws lie in [0, 1)
+            double p = 0.5 * std::erfc(-next() / std::sqrt(2.0));
+            return p < 1 ? p : std::nextafter(1.0, 0.0);
+        }
+
+        double rexp() {
+            return -std::log1p(-runif());
+        }
+
+        double rnorm() {
+            return next();
+        }
+
+        std::size_t rbinom(std::size_t n, double p) {
+            std::size_t res = 0;
+            for(std::size_t i = 0; i < n; ++i) {
+                res += runif() < p;
+            }
+            return res;
+        }
+
+};
+
+/**
+ * Walker's alias table (Vose, 1991, doi: 10.1109/32.92917) for drawing 
+ * indices from a discrete distribution in O(1) time per draw, after O(n) 
+ * setup
+*/
+class AliasTable {
+
+    private:
+
+        // probability of keeping each index, and the index to use otherwise
+        std::vector<double> keep;
+        std::vector<std::size_t> alias;
+
+    public:
+
+        /**
+         * @param weights non-negative weights for each index, which need not 
+         *   be normalized, and must not all be zero
+        */
+        explicit AliasTable(const std::vector<double> & weights) :
+            keep(weights.size()), alias(weights.size()) {
+
+            std::size_t n = weights.size();
+            double total = 0;
+            for(double w : weights) {
+                total += w;
+            }
+
+            // split indices by whether their scaled weights are below 1
+            std::vector<std::size_t> small, large;
+            for(std::size_t i = 0; i < n; ++i) {
+                keep[i] = weights[i] * n / total;
+                alias[i] = i;
+                if(keep[i] < 1) {
+                    small.push_back(i);
+                } else {
+                    large.push_back(i);
+                }
+            }
+
+            // fill each small index's remaining mass from a large index
+            while(!small.empty() && !large.empty()) {
+                std::size_t s = small.back();
+                small.pop_back();
+                std::size_t l = large.back();
+                alias[s] = l;
+                keep[l] -= 1 - keep[s];
+                if(keep[l] < 1) {
+                    large.pop_back();
+                    small.push_back(l);
+                }
+            }
+
+            // remaining indices only differ from 1 due to rounding error
+            for(std::size_t i : small) {
+                keep[i] = 1;
+            }
+            for(std::size_t i : large) {
+                keep[i] = 1;
+            }
+        }
+
+        std::size_t size() const { return keep.size(); }
+
+        template<typename RandomSource>
+        std::size_t sample(RandomSource & rng) const {
+            double u = rng.runif() * keep.size();
+            std::size_t i = std::min(
+                static_cast<std::size_t>(u), keep.size() - 1
+            );
+            return u - i < keep[i] ? i : alias[i];
+        }
+
+};
+
+/**
+ * Move a random number source to the start of a block of random numbers, if
+ * the source is divided into blocks
+*/
+template<typename RandomSource>
+void seek_random_block(RandomSource & random_source, std::size_t block) { }
+
+inline void seek_random_block(
+    AuxiliaryRandom & random_source, std::size_t block
+) {
+    random_source.seek(block);
+}
+
+inline void seek_random_block(
+    BlockStreamRandom & random_source, std::size_t block
+) {
+    random_source.seek(block);
+}
+
+/**
+ * Shared instance of a random number source type, for objects that are not
+ * given a specific source to draw from
+*/
+template<typename RandomSource>
+RandomSource & default_random_source() {
+    static RandomSource source;
+    return source;
+}
+
+#endif
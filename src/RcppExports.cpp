@@ -30,6 +30,76 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// Test__AppliedLikelihoodFamilyFromGPS
+std::vector<double> Test__AppliedLikelihoodFamilyFromGPS(std::vector<double> eastings, std::vector<double> northings, std::vector<double> hdops, double uere, std::vector<std::size_t> t, std::size_t nt, Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > states);
+RcppExport SEXP _movecon_Test__AppliedLikelihoodFamilyFromGPS(SEXP eastingsSEXP, SEXP northingsSEXP, SEXP hdopsSEXP, SEXP uereSEXP, SEXP tSEXP, SEXP ntSEXP, SEXP statesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::vector<double> >::type eastings(eastingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type northings(northingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type hdops(hdopsSEXP);
+    Rcpp::traits::input_parameter< double >::type uere(uereSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::size_t> >::type t(tSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nt(ntSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > >::type states(statesSEXP);
+    rcpp_result_gen = Rcpp::wrap(Test__AppliedLikelihoodFamilyFromGPS(eastings, northings, hdops, uere, t, nt, states));
+    return rcpp_result_gen;
+END_RCPP
+}
+// build_covariate_stack
+Rcpp::XPtr<CovariateStack> build_covariate_stack(Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::List layers, std::vector<std::size_t> schedule, std::size_t period_length);
+RcppExport SEXP _movecon_build_covariate_stack(SEXP statespaceSEXP, SEXP layersSEXP, SEXP scheduleSEXP, SEXP period_lengthSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type layers(layersSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::size_t> >::type schedule(scheduleSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type period_length(period_lengthSEXP);
+    rcpp_result_gen = Rcpp::wrap(build_covariate_stack(statespace, layers, schedule, period_length));
+    return rcpp_result_gen;
+END_RCPP
+}
+// covariate_stack_rates
+Rcpp::List covariate_stack_rates(Rcpp::XPtr<CovariateStack> stack, Eigen::VectorXd beta, double delta, std::size_t t);
+RcppExport SEXP _movecon_covariate_stack_rates(SEXP stackSEXP, SEXP betaSEXP, SEXP deltaSEXP, SEXP tSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<CovariateStack> >::type stack(stackSEXP);
+    Rcpp::traits::input_parameter< Eigen::VectorXd >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< double >::type delta(deltaSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type t(tSEXP);
+    rcpp_result_gen = Rcpp::wrap(covariate_stack_rates(stack, beta, delta, t));
+    return rcpp_result_gen;
+END_RCPP
+}
+// build_directional_bias
+Rcpp::XPtr<RookDirectionalBias> build_directional_bias(Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::NumericMatrix directional_covariates);
+RcppExport SEXP _movecon_build_directional_bias(SEXP statespaceSEXP, SEXP directional_covariatesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type directional_covariates(directional_covariatesSEXP);
+    rcpp_result_gen = Rcpp::wrap(build_directional_bias(statespace, directional_covariates));
+    return rcpp_result_gen;
+END_RCPP
+}
+// directional_bias_probabilities
+Rcpp::NumericVector directional_bias_probabilities(Rcpp::XPtr<RookDirectionalBias> bias, double directional_persistence, Eigen::VectorXd gamma);
+RcppExport SEXP _movecon_directional_bias_probabilities(SEXP biasSEXP, SEXP directional_persistenceSEXP, SEXP gammaSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<RookDirectionalBias> >::type bias(biasSEXP);
+    Rcpp::traits::input_parameter< double >::type directional_persistence(directional_persistenceSEXP);
+    Rcpp::traits::input_parameter< Eigen::VectorXd >::type gamma(gammaSEXP);
+    rcpp_result_gen = Rcpp::wrap(directional_bias_probabilities(bias, directional_persistence, gamma));
+    return rcpp_result_gen;
+END_RCPP
+}
 // Test__Directional_Covariate
 double Test__Directional_Covariate(std::string x, std::string y);
 RcppExport SEXP _movecon_Test__Directional_Covariate(SEXP xSEXP, SEXP ySEXP) {
@@ -56,6 +126,40 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// build_coarse_statespace
+Rcpp::XPtr<RookDirectionalStatespace> build_coarse_statespace(Rcpp::XPtr<RookDirectionalStatespace> statespace, std::size_t k);
+RcppExport SEXP _movecon_build_coarse_statespace(SEXP statespaceSEXP, SEXP kSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type k(kSEXP);
+    rcpp_result_gen = Rcpp::wrap(build_coarse_statespace(statespace, k));
+    return rcpp_result_gen;
+END_RCPP
+}
+// statespace_state_locations
+Rcpp::List statespace_state_locations(Rcpp::XPtr<RookDirectionalStatespace> statespace);
+RcppExport SEXP _movecon_statespace_state_locations(SEXP statespaceSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    rcpp_result_gen = Rcpp::wrap(statespace_state_locations(statespace));
+    return rcpp_result_gen;
+END_RCPP
+}
+// state_sample_ids
+Rcpp::IntegerVector state_sample_ids(Rcpp::XPtr<std::vector<RookDirectionalStatespace::StateType*>> states);
+RcppExport SEXP _movecon_state_sample_ids(SEXP statesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<std::vector<RookDirectionalStatespace::StateType*>> >::type states(statesSEXP);
+    rcpp_result_gen = Rcpp::wrap(state_sample_ids(states));
+    return rcpp_result_gen;
+END_RCPP
+}
 // extract_statespace_location
 Rcpp::List extract_statespace_location(Rcpp::XPtr<RookDirectionalStatespace> statespace, std::size_t easting_ind, std::size_t northing_ind);
 RcppExport SEXP _movecon_extract_statespace_location(SEXP statespaceSEXP, SEXP easting_indSEXP, SEXP northing_indSEXP) {
@@ -83,6 +187,17 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// statespace_columns
+Rcpp::List statespace_columns(Rcpp::XPtr<RookDirectionalStatespace> statespace);
+RcppExport SEXP _movecon_statespace_columns(SEXP statespaceSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    rcpp_result_gen = Rcpp::wrap(statespace_columns(statespace));
+    return rcpp_result_gen;
+END_RCPP
+}
 // build_statespace_search
 Rcpp::XPtr<RookDirectionalStatespaceSearch> build_statespace_search(Rcpp::XPtr<RookDirectionalStatespace> statespace);
 RcppExport SEXP _movecon_build_statespace_search(SEXP statespaceSEXP) {
@@ -120,6 +235,198 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// nearest_locations_in_domain
+Rcpp::List nearest_locations_in_domain(Rcpp::XPtr<RookDirectionalStatespaceSearch> statespace_search, Rcpp::NumericVector eastings, Rcpp::NumericVector northings, std::size_t nthreads);
+RcppExport SEXP _movecon_nearest_locations_in_domain(SEXP statespace_searchSEXP, SEXP eastingsSEXP, SEXP northingsSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<RookDirectionalStatespaceSearch> >::type statespace_search(statespace_searchSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type eastings(eastingsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type northings(northingsSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(nearest_locations_in_domain(statespace_search, eastings, northings, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// statespace_search_locations
+Rcpp::List statespace_search_locations(Rcpp::XPtr<RookDirectionalStatespaceSearch> statespace_search);
+RcppExport SEXP _movecon_statespace_search_locations(SEXP statespace_searchSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<RookDirectionalStatespaceSearch> >::type statespace_search(statespace_searchSEXP);
+    rcpp_result_gen = Rcpp::wrap(statespace_search_locations(statespace_search));
+    return rcpp_result_gen;
+END_RCPP
+}
+// build_checkpointed_filter_from_gps
+Rcpp::XPtr<CheckpointedFilter> build_checkpointed_filter_from_gps(/* likelihood components */     std::vector<double> eastings, std::vector<double> northings, std::vector<double> hdops, double uere, std::vector<std::size_t> t, std::size_t nt, /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > initial_latent_state_sample, /* model parameters */     double directional_persistence, Eigen::VectorXd beta, double delta);
+RcppExport SEXP _movecon_build_checkpointed_filter_from_gps(SEXP eastingsSEXP, SEXP northingsSEXP, SEXP hdopsSEXP, SEXP uereSEXP, SEXP tSEXP, SEXP ntSEXP, SEXP statespaceSEXP, SEXP initial_latent_state_sampleSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP deltaSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< /* likelihood components */     std::vector<double> >::type eastings(eastingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type northings(northingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type hdops(hdopsSEXP);
+    Rcpp::traits::input_parameter< double >::type uere(uereSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::size_t> >::type t(tSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nt(ntSEXP);
+    Rcpp::traits::input_parameter< /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > >::type initial_latent_state_sample(initial_latent_state_sampleSEXP);
+    Rcpp::traits::input_parameter< /* model parameters */     double >::type directional_persistence(directional_persistenceSEXP);
+    Rcpp::traits::input_parameter< Eigen::VectorXd >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< double >::type delta(deltaSEXP);
+    rcpp_result_gen = Rcpp::wrap(build_checkpointed_filter_from_gps(eastings, northings, hdops, uere, t, nt, statespace, initial_latent_state_sample, directional_persistence, beta, delta));
+    return rcpp_result_gen;
+END_RCPP
+}
+// checkpointed_filter_run
+Rcpp::List checkpointed_filter_run(Rcpp::XPtr<CheckpointedFilter> filter, std::size_t ntimepoints, std::string checkpoint);
+RcppExport SEXP _movecon_checkpointed_filter_run(SEXP filterSEXP, SEXP ntimepointsSEXP, SEXP checkpointSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<CheckpointedFilter> >::type filter(filterSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type ntimepoints(ntimepointsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type checkpoint(checkpointSEXP);
+    rcpp_result_gen = Rcpp::wrap(checkpointed_filter_run(filter, ntimepoints, checkpoint));
+    return rcpp_result_gen;
+END_RCPP
+}
+// checkpointed_filter_resume
+std::size_t checkpointed_filter_resume(Rcpp::XPtr<CheckpointedFilter> filter, std::string checkpoint);
+RcppExport SEXP _movecon_checkpointed_filter_resume(SEXP filterSEXP, SEXP checkpointSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<CheckpointedFilter> >::type filter(filterSEXP);
+    Rcpp::traits::input_parameter< std::string >::type checkpoint(checkpointSEXP);
+    rcpp_result_gen = Rcpp::wrap(checkpointed_filter_resume(filter, checkpoint));
+    return rcpp_result_gen;
+END_RCPP
+}
+// read_state_id_file
+Rcpp::List read_state_id_file(std::string path);
+RcppExport SEXP _movecon_read_state_id_file(SEXP pathSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    rcpp_result_gen = Rcpp::wrap(read_state_id_file(path));
+    return rcpp_result_gen;
+END_RCPP
+}
+// build_filter_session_from_gps
+Rcpp::XPtr<FilterSession> build_filter_session_from_gps(/* likelihood components */     std::vector<double> eastings, std::vector<double> northings, std::vector<double> hdops, double uere, std::vector<std::size_t> t, std::size_t nt, /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > initial_latent_state_sample);
+RcppExport SEXP _movecon_build_filter_session_from_gps(SEXP eastingsSEXP, SEXP northingsSEXP, SEXP hdopsSEXP, SEXP uereSEXP, SEXP tSEXP, SEXP ntSEXP, SEXP statespaceSEXP, SEXP initial_latent_state_sampleSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< /* likelihood components */     std::vector<double> >::type eastings(eastingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type northings(northingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type hdops(hdopsSEXP);
+    Rcpp::traits::input_parameter< double >::type uere(uereSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::size_t> >::type t(tSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nt(ntSEXP);
+    Rcpp::traits::input_parameter< /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > >::type initial_latent_state_sample(initial_latent_state_sampleSEXP);
+    rcpp_result_gen = Rcpp::wrap(build_filter_session_from_gps(eastings, northings, hdops, uere, t, nt, statespace, initial_latent_state_sample));
+    return rcpp_result_gen;
+END_RCPP
+}
+// filter_session_loglik
+double filter_session_loglik(Rcpp::XPtr<FilterSession> session, /* model parameters */     double directional_persistence, Rcpp::NumericVector beta, double delta, double threshold, double margin);
+RcppExport SEXP _movecon_filter_session_loglik(SEXP sessionSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP deltaSEXP, SEXP thresholdSEXP, SEXP marginSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<FilterSession> >::type session(sessionSEXP);
+    Rcpp::traits::input_parameter< /* model parameters */     double >::type directional_persistence(directional_persistenceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< double >::type delta(deltaSEXP);
+    Rcpp::traits::input_parameter< double >::type threshold(thresholdSEXP);
+    Rcpp::traits::input_parameter< double >::type margin(marginSEXP);
+    rcpp_result_gen = Rcpp::wrap(filter_session_loglik(session, directional_persistence, beta, delta, threshold, margin));
+    return rcpp_result_gen;
+END_RCPP
+}
+// filter_session_truncated
+bool filter_session_truncated(Rcpp::XPtr<FilterSession> session);
+RcppExport SEXP _movecon_filter_session_truncated(SEXP sessionSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<FilterSession> >::type session(sessionSEXP);
+    rcpp_result_gen = Rcpp::wrap(filter_session_truncated(session));
+    return rcpp_result_gen;
+END_RCPP
+}
+// build_fixed_lag_smoother
+Rcpp::XPtr<FixedLagSmoother> build_fixed_lag_smoother(/* filter components */     Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > initial_latent_state_sample, std::size_t lag, /* model parameters */     double directional_persistence, Rcpp::NumericVector beta, double delta, /* likelihood components */     double uere);
+RcppExport SEXP _movecon_build_fixed_lag_smoother(SEXP statespaceSEXP, SEXP initial_latent_state_sampleSEXP, SEXP lagSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP deltaSEXP, SEXP uereSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > >::type initial_latent_state_sample(initial_latent_state_sampleSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type lag(lagSEXP);
+    Rcpp::traits::input_parameter< /* model parameters */     double >::type directional_persistence(directional_persistenceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< double >::type delta(deltaSEXP);
+    Rcpp::traits::input_parameter< /* likelihood components */     double >::type uere(uereSEXP);
+    rcpp_result_gen = Rcpp::wrap(build_fixed_lag_smoother(statespace, initial_latent_state_sample, lag, directional_persistence, beta, delta, uere));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fixed_lag_smoother_append_observation
+double fixed_lag_smoother_append_observation(Rcpp::XPtr<FixedLagSmoother> smoother, double easting, double northing, double hdop, std::size_t nsteps);
+RcppExport SEXP _movecon_fixed_lag_smoother_append_observation(SEXP smootherSEXP, SEXP eastingSEXP, SEXP northingSEXP, SEXP hdopSEXP, SEXP nstepsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<FixedLagSmoother> >::type smoother(smootherSEXP);
+    Rcpp::traits::input_parameter< double >::type easting(eastingSEXP);
+    Rcpp::traits::input_parameter< double >::type northing(northingSEXP);
+    Rcpp::traits::input_parameter< double >::type hdop(hdopSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nsteps(nstepsSEXP);
+    rcpp_result_gen = Rcpp::wrap(fixed_lag_smoother_append_observation(smoother, easting, northing, hdop, nsteps));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fixed_lag_smoother_smoothed_at
+Rcpp::List fixed_lag_smoother_smoothed_at(Rcpp::XPtr<FixedLagSmoother> smoother, std::size_t t);
+RcppExport SEXP _movecon_fixed_lag_smoother_smoothed_at(SEXP smootherSEXP, SEXP tSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<FixedLagSmoother> >::type smoother(smootherSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type t(tSEXP);
+    rcpp_result_gen = Rcpp::wrap(fixed_lag_smoother_smoothed_at(smoother, t));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Particle_Filter_Likelihood_From_GPS_Parameter_Batch
+std::vector<double> Particle_Filter_Likelihood_From_GPS_Parameter_Batch(/* likelihood components */     std::vector<double> eastings, std::vector<double> northings, std::vector<double> hdops, double uere, std::vector<std::size_t> t, std::size_t nt, /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > initial_latent_state_sample, /* model parameters */     std::vector<double> directional_persistence, Eigen::MatrixXd beta, double delta);
+RcppExport SEXP _movecon_Particle_Filter_Likelihood_From_GPS_Parameter_Batch(SEXP eastingsSEXP, SEXP northingsSEXP, SEXP hdopsSEXP, SEXP uereSEXP, SEXP tSEXP, SEXP ntSEXP, SEXP statespaceSEXP, SEXP initial_latent_state_sampleSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP deltaSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< /* likelihood components */     std::vector<double> >::type eastings(eastingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type northings(northingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type hdops(hdopsSEXP);
+    Rcpp::traits::input_parameter< double >::type uere(uereSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::size_t> >::type t(tSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nt(ntSEXP);
+    Rcpp::traits::input_parameter< /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > >::type initial_latent_state_sample(initial_latent_state_sampleSEXP);
+    Rcpp::traits::input_parameter< /* model parameters */     std::vector<double> >::type directional_persistence(directional_persistenceSEXP);
+    Rcpp::traits::input_parameter< Eigen::MatrixXd >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< double >::type delta(deltaSEXP);
+    rcpp_result_gen = Rcpp::wrap(Particle_Filter_Likelihood_From_GPS_Parameter_Batch(eastings, northings, hdops, uere, t, nt, statespace, initial_latent_state_sample, directional_persistence, beta, delta));
+    return rcpp_result_gen;
+END_RCPP
+}
 // Test__Particle_Steps
 Rcpp::List Test__Particle_Steps(Rcpp::XPtr<RookDirectionalStatespace> statespace, std::string last_movement_direction, std::size_t easting_ind, std::size_t northing_ind, double directional_persistence, Eigen::VectorXd beta, double delta, std::size_t nsteps);
 RcppExport SEXP _movecon_Test__Particle_Steps(SEXP statespaceSEXP, SEXP last_movement_directionSEXP, SEXP easting_indSEXP, SEXP northing_indSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP deltaSEXP, SEXP nstepsSEXP) {
@@ -181,9 +488,186 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// Particle_Filter_Likelihood_From_GPS_With_Reachability
+Rcpp::List Particle_Filter_Likelihood_From_GPS_With_Reachability(/* likelihood components */     std::vector<double> eastings, std::vector<double> northings, std::vector<double> hdops, double uere, std::vector<std::size_t> t, std::size_t nt, /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > initial_latent_state_sample, Rcpp::XPtr<RookDirectionalReachability> reachability, bool guided, /* model parameters */     double directional_persistence, Eigen::VectorXd beta, double delta);
+RcppExport SEXP _movecon_Particle_Filter_Likelihood_From_GPS_With_Reachability(SEXP eastingsSEXP, SEXP northingsSEXP, SEXP hdopsSEXP, SEXP uereSEXP, SEXP tSEXP, SEXP ntSEXP, SEXP statespaceSEXP, SEXP initial_latent_state_sampleSEXP, SEXP reachabilitySEXP, SEXP guidedSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP deltaSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< /* likelihood components */     std::vector<double> >::type eastings(eastingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type northings(northingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type hdops(hdopsSEXP);
+    Rcpp::traits::input_parameter< double >::type uere(uereSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::size_t> >::type t(tSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nt(ntSEXP);
+    Rcpp::traits::input_parameter< /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > >::type initial_latent_state_sample(initial_latent_state_sampleSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<RookDirectionalReachability> >::type reachability(reachabilitySEXP);
+    Rcpp::traits::input_parameter< bool >::type guided(guidedSEXP);
+    Rcpp::traits::input_parameter< /* model parameters */     double >::type directional_persistence(directional_persistenceSEXP);
+    Rcpp::traits::input_parameter< Eigen::VectorXd >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< double >::type delta(deltaSEXP);
+    rcpp_result_gen = Rcpp::wrap(Particle_Filter_Likelihood_From_GPS_With_Reachability(eastings, northings, hdops, uere, t, nt, statespace, initial_latent_state_sample, reachability, guided, directional_persistence, beta, delta));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Particle_Filter_Likelihood_From_GPS_With_Lookahead
+Rcpp::List Particle_Filter_Likelihood_From_GPS_With_Lookahead(/* likelihood components */     std::vector<double> eastings, std::vector<double> northings, std::vector<double> hdops, double uere, std::vector<std::size_t> t, std::size_t nt, /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > initial_latent_state_sample, double step_sd, /* model parameters */     double directional_persistence, Eigen::VectorXd beta, double delta);
+RcppExport SEXP _movecon_Particle_Filter_Likelihood_From_GPS_With_Lookahead(SEXP eastingsSEXP, SEXP northingsSEXP, SEXP hdopsSEXP, SEXP uereSEXP, SEXP tSEXP, SEXP ntSEXP, SEXP statespaceSEXP, SEXP initial_latent_state_sampleSEXP, SEXP step_sdSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP deltaSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< /* likelihood components */     std::vector<double> >::type eastings(eastingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type northings(northingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type hdops(hdopsSEXP);
+    Rcpp::traits::input_parameter< double >::type uere(uereSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::size_t> >::type t(tSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nt(ntSEXP);
+    Rcpp::traits::input_parameter< /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > >::type initial_latent_state_sample(initial_latent_state_sampleSEXP);
+    Rcpp::traits::input_parameter< double >::type step_sd(step_sdSEXP);
+    Rcpp::traits::input_parameter< /* model parameters */     double >::type directional_persistence(directional_persistenceSEXP);
+    Rcpp::traits::input_parameter< Eigen::VectorXd >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< double >::type delta(deltaSEXP);
+    rcpp_result_gen = Rcpp::wrap(Particle_Filter_Likelihood_From_GPS_With_Lookahead(eastings, northings, hdops, uere, t, nt, statespace, initial_latent_state_sample, step_sd, directional_persistence, beta, delta));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Particle_Filter_Likelihood_From_GPS_Gillespie
+Rcpp::List Particle_Filter_Likelihood_From_GPS_Gillespie(/* likelihood components */     std::vector<double> eastings, std::vector<double> northings, std::vector<double> hdops, double uere, std::vector<double> times, /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > initial_latent_state_sample, /* model parameters */     double directional_persistence, Eigen::VectorXd beta);
+RcppExport SEXP _movecon_Particle_Filter_Likelihood_From_GPS_Gillespie(SEXP eastingsSEXP, SEXP northingsSEXP, SEXP hdopsSEXP, SEXP uereSEXP, SEXP timesSEXP, SEXP statespaceSEXP, SEXP initial_latent_state_sampleSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< /* likelihood components */     std::vector<double> >::type eastings(eastingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type northings(northingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type hdops(hdopsSEXP);
+    Rcpp::traits::input_parameter< double >::type uere(uereSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > >::type initial_latent_state_sample(initial_latent_state_sampleSEXP);
+    Rcpp::traits::input_parameter< /* model parameters */     double >::type directional_persistence(directional_persistenceSEXP);
+    Rcpp::traits::input_parameter< Eigen::VectorXd >::type beta(betaSEXP);
+    rcpp_result_gen = Rcpp::wrap(Particle_Filter_Likelihood_From_GPS_Gillespie(eastings, northings, hdops, uere, times, statespace, initial_latent_state_sample, directional_persistence, beta));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Particle_Filter_Likelihood_From_GPS_Time_Varying
+Rcpp::List Particle_Filter_Likelihood_From_GPS_Time_Varying(/* likelihood components */     std::vector<double> eastings, std::vector<double> northings, std::vector<double> hdops, double uere, std::vector<std::size_t> t, std::size_t nt, /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > initial_latent_state_sample, Rcpp::XPtr<CovariateStack> stack, /* model parameters */     double directional_persistence, Eigen::VectorXd beta, double delta);
+RcppExport SEXP _movecon_Particle_Filter_Likelihood_From_GPS_Time_Varying(SEXP eastingsSEXP, SEXP northingsSEXP, SEXP hdopsSEXP, SEXP uereSEXP, SEXP tSEXP, SEXP ntSEXP, SEXP statespaceSEXP, SEXP initial_latent_state_sampleSEXP, SEXP stackSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP deltaSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< /* likelihood components */     std::vector<double> >::type eastings(eastingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type northings(northingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type hdops(hdopsSEXP);
+    Rcpp::traits::input_parameter< double >::type uere(uereSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::size_t> >::type t(tSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nt(ntSEXP);
+    Rcpp::traits::input_parameter< /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > >::type initial_latent_state_sample(initial_latent_state_sampleSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<CovariateStack> >::type stack(stackSEXP);
+    Rcpp::traits::input_parameter< /* model parameters */     double >::type directional_persistence(directional_persistenceSEXP);
+    Rcpp::traits::input_parameter< Eigen::VectorXd >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< double >::type delta(deltaSEXP);
+    rcpp_result_gen = Rcpp::wrap(Particle_Filter_Likelihood_From_GPS_Time_Varying(eastings, northings, hdops, uere, t, nt, statespace, initial_latent_state_sample, stack, directional_persistence, beta, delta));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Particle_Filter_Likelihood_From_GPS_With_Directional_Bias
+Rcpp::List Particle_Filter_Likelihood_From_GPS_With_Directional_Bias(/* likelihood components */     std::vector<double> eastings, std::vector<double> northings, std::vector<double> hdops, double uere, std::vector<std::size_t> t, std::size_t nt, /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > initial_latent_state_sample, Rcpp::XPtr<RookDirectionalBias> bias, /* model parameters */     double directional_persistence, Eigen::VectorXd beta, Eigen::VectorXd gamma, double delta);
+RcppExport SEXP _movecon_Particle_Filter_Likelihood_From_GPS_With_Directional_Bias(SEXP eastingsSEXP, SEXP northingsSEXP, SEXP hdopsSEXP, SEXP uereSEXP, SEXP tSEXP, SEXP ntSEXP, SEXP statespaceSEXP, SEXP initial_latent_state_sampleSEXP, SEXP biasSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP gammaSEXP, SEXP deltaSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< /* likelihood components */     std::vector<double> >::type eastings(eastingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type northings(northingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type hdops(hdopsSEXP);
+    Rcpp::traits::input_parameter< double >::type uere(uereSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::size_t> >::type t(tSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nt(ntSEXP);
+    Rcpp::traits::input_parameter< /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > >::type initial_latent_state_sample(initial_latent_state_sampleSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<RookDirectionalBias> >::type bias(biasSEXP);
+    Rcpp::traits::input_parameter< /* model parameters */     double >::type directional_persistence(directional_persistenceSEXP);
+    Rcpp::traits::input_parameter< Eigen::VectorXd >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< Eigen::VectorXd >::type gamma(gammaSEXP);
+    Rcpp::traits::input_parameter< double >::type delta(deltaSEXP);
+    rcpp_result_gen = Rcpp::wrap(Particle_Filter_Likelihood_From_GPS_With_Directional_Bias(eastings, northings, hdops, uere, t, nt, statespace, initial_latent_state_sample, bias, directional_persistence, beta, gamma, delta));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Particle_Filter_State_Ids_From_GPS
+Rcpp::List Particle_Filter_State_Ids_From_GPS(/* likelihood components */     std::vector<double> eastings, std::vector<double> northings, std::vector<double> hdops, double uere, std::vector<std::size_t> t, std::size_t nt, /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > initial_latent_state_sample, /* model parameters */     double directional_persistence, Eigen::VectorXd beta, double delta, /* output components */     std::size_t stride);
+RcppExport SEXP _movecon_Particle_Filter_State_Ids_From_GPS(SEXP eastingsSEXP, SEXP northingsSEXP, SEXP hdopsSEXP, SEXP uereSEXP, SEXP tSEXP, SEXP ntSEXP, SEXP statespaceSEXP, SEXP initial_latent_state_sampleSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP deltaSEXP, SEXP strideSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< /* likelihood components */     std::vector<double> >::type eastings(eastingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type northings(northingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type hdops(hdopsSEXP);
+    Rcpp::traits::input_parameter< double >::type uere(uereSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::size_t> >::type t(tSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nt(ntSEXP);
+    Rcpp::traits::input_parameter< /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > >::type initial_latent_state_sample(initial_latent_state_sampleSEXP);
+    Rcpp::traits::input_parameter< /* model parameters */     double >::type directional_persistence(directional_persistenceSEXP);
+    Rcpp::traits::input_parameter< Eigen::VectorXd >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< double >::type delta(deltaSEXP);
+    Rcpp::traits::input_parameter< /* output components */     std::size_t >::type stride(strideSEXP);
+    rcpp_result_gen = Rcpp::wrap(Particle_Filter_State_Ids_From_GPS(eastings, northings, hdops, uere, t, nt, statespace, initial_latent_state_sample, directional_persistence, beta, delta, stride));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Particle_Filter_State_Ids_To_File_From_GPS
+Rcpp::List Particle_Filter_State_Ids_To_File_From_GPS(/* likelihood components */     std::vector<double> eastings, std::vector<double> northings, std::vector<double> hdops, double uere, std::vector<std::size_t> t, std::size_t nt, /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > initial_latent_state_sample, /* model parameters */     double directional_persistence, Eigen::VectorXd beta, double delta, /* output components */     std::string path, std::size_t stride);
+RcppExport SEXP _movecon_Particle_Filter_State_Ids_To_File_From_GPS(SEXP eastingsSEXP, SEXP northingsSEXP, SEXP hdopsSEXP, SEXP uereSEXP, SEXP tSEXP, SEXP ntSEXP, SEXP statespaceSEXP, SEXP initial_latent_state_sampleSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP deltaSEXP, SEXP pathSEXP, SEXP strideSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< /* likelihood components */     std::vector<double> >::type eastings(eastingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type northings(northingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type hdops(hdopsSEXP);
+    Rcpp::traits::input_parameter< double >::type uere(uereSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::size_t> >::type t(tSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nt(ntSEXP);
+    Rcpp::traits::input_parameter< /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > >::type initial_latent_state_sample(initial_latent_state_sampleSEXP);
+    Rcpp::traits::input_parameter< /* model parameters */     double >::type directional_persistence(directional_persistenceSEXP);
+    Rcpp::traits::input_parameter< Eigen::VectorXd >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< double >::type delta(deltaSEXP);
+    Rcpp::traits::input_parameter< /* output components */     std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type stride(strideSEXP);
+    rcpp_result_gen = Rcpp::wrap(Particle_Filter_State_Ids_To_File_From_GPS(eastings, northings, hdops, uere, t, nt, statespace, initial_latent_state_sample, directional_persistence, beta, delta, path, stride));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Particle_Filter_Occupancy_From_GPS
+Rcpp::List Particle_Filter_Occupancy_From_GPS(/* likelihood components */     std::vector<double> eastings, std::vector<double> northings, std::vector<double> hdops, double uere, std::vector<std::size_t> t, std::size_t nt, /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > initial_latent_state_sample, /* model parameters */     double directional_persistence, Eigen::VectorXd beta, double delta, /* output components */     std::size_t window, std::size_t stride);
+RcppExport SEXP _movecon_Particle_Filter_Occupancy_From_GPS(SEXP eastingsSEXP, SEXP northingsSEXP, SEXP hdopsSEXP, SEXP uereSEXP, SEXP tSEXP, SEXP ntSEXP, SEXP statespaceSEXP, SEXP initial_latent_state_sampleSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP deltaSEXP, SEXP windowSEXP, SEXP strideSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< /* likelihood components */     std::vector<double> >::type eastings(eastingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type northings(northingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type hdops(hdopsSEXP);
+    Rcpp::traits::input_parameter< double >::type uere(uereSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::size_t> >::type t(tSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nt(ntSEXP);
+    Rcpp::traits::input_parameter< /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > >::type initial_latent_state_sample(initial_latent_state_sampleSEXP);
+    Rcpp::traits::input_parameter< /* model parameters */     double >::type directional_persistence(directional_persistenceSEXP);
+    Rcpp::traits::input_parameter< Eigen::VectorXd >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< double >::type delta(deltaSEXP);
+    Rcpp::traits::input_parameter< /* output components */     std::size_t >::type window(windowSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type stride(strideSEXP);
+    rcpp_result_gen = Rcpp::wrap(Particle_Filter_Occupancy_From_GPS(eastings, northings, hdops, uere, t, nt, statespace, initial_latent_state_sample, directional_persistence, beta, delta, window, stride));
+    return rcpp_result_gen;
+END_RCPP
+}
 // Test__Particle_Gillespie_Steps
-Rcpp::List Test__Particle_Gillespie_Steps(Rcpp::XPtr<RookDirectionalStatespace> statespace, std::string last_movement_direction, std::size_t easting_ind, std::size_t northing_ind, double directional_persistence, Eigen::VectorXd beta, double delta, std::vector<double> times);
-RcppExport SEXP _movecon_Test__Particle_Gillespie_Steps(SEXP statespaceSEXP, SEXP last_movement_directionSEXP, SEXP easting_indSEXP, SEXP northing_indSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP deltaSEXP, SEXP timesSEXP) {
+Rcpp::List Test__Particle_Gillespie_Steps(Rcpp::XPtr<RookDirectionalStatespace> statespace, std::string last_movement_direction, std::size_t easting_ind, std::size_t northing_ind, double directional_persistence, Eigen::VectorXd beta, std::vector<double> times);
+RcppExport SEXP _movecon_Test__Particle_Gillespie_Steps(SEXP statespaceSEXP, SEXP last_movement_directionSEXP, SEXP easting_indSEXP, SEXP northing_indSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP timesSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -193,9 +677,96 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< std::size_t >::type northing_ind(northing_indSEXP);
     Rcpp::traits::input_parameter< double >::type directional_persistence(directional_persistenceSEXP);
     Rcpp::traits::input_parameter< Eigen::VectorXd >::type beta(betaSEXP);
-    Rcpp::traits::input_parameter< double >::type delta(deltaSEXP);
     Rcpp::traits::input_parameter< std::vector<double> >::type times(timesSEXP);
-    rcpp_result_gen = Rcpp::wrap(Test__Particle_Gillespie_Steps(statespace, last_movement_direction, easting_ind, northing_ind, directional_persistence, beta, delta, times));
+    rcpp_result_gen = Rcpp::wrap(Test__Particle_Gillespie_Steps(statespace, last_movement_direction, easting_ind, northing_ind, directional_persistence, beta, times));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Particle_Marginal_MH_From_GPS
+Rcpp::List Particle_Marginal_MH_From_GPS(/* likelihood components */     std::vector<double> eastings, std::vector<double> northings, std::vector<double> hdops, double uere, std::vector<std::size_t> t, std::size_t nt, /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > initial_latent_state_sample, double delta, /* sampler components */     Rcpp::List priors, Eigen::MatrixXd proposal_covariance, Eigen::MatrixXd initial_parameters, std::size_t niter, std::size_t nthreads, double correlation);
+RcppExport SEXP _movecon_Particle_Marginal_MH_From_GPS(SEXP eastingsSEXP, SEXP northingsSEXP, SEXP hdopsSEXP, SEXP uereSEXP, SEXP tSEXP, SEXP ntSEXP, SEXP statespaceSEXP, SEXP initial_latent_state_sampleSEXP, SEXP deltaSEXP, SEXP priorsSEXP, SEXP proposal_covarianceSEXP, SEXP initial_parametersSEXP, SEXP niterSEXP, SEXP nthreadsSEXP, SEXP correlationSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< /* likelihood components */     std::vector<double> >::type eastings(eastingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type northings(northingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type hdops(hdopsSEXP);
+    Rcpp::traits::input_parameter< double >::type uere(uereSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::size_t> >::type t(tSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nt(ntSEXP);
+    Rcpp::traits::input_parameter< /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > >::type initial_latent_state_sample(initial_latent_state_sampleSEXP);
+    Rcpp::traits::input_parameter< double >::type delta(deltaSEXP);
+    Rcpp::traits::input_parameter< /* sampler components */     Rcpp::List >::type priors(priorsSEXP);
+    Rcpp::traits::input_parameter< Eigen::MatrixXd >::type proposal_covariance(proposal_covarianceSEXP);
+    Rcpp::traits::input_parameter< Eigen::MatrixXd >::type initial_parameters(initial_parametersSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type niter(niterSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nthreads(nthreadsSEXP);
+    Rcpp::traits::input_parameter< double >::type correlation(correlationSEXP);
+    rcpp_result_gen = Rcpp::wrap(Particle_Marginal_MH_From_GPS(eastings, northings, hdops, uere, t, nt, statespace, initial_latent_state_sample, delta, priors, proposal_covariance, initial_parameters, niter, nthreads, correlation));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Delayed_Acceptance_MH_From_GPS
+Rcpp::List Delayed_Acceptance_MH_From_GPS(/* likelihood components */     std::vector<double> eastings, std::vector<double> northings, std::vector<double> hdops, double uere, std::vector<std::size_t> t, std::size_t nt, /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > initial_latent_state_sample, double delta, /* sampler components */     Rcpp::List priors, Eigen::MatrixXd proposal_covariance, Eigen::MatrixXd initial_parameters, std::size_t niter, std::size_t coarsening, std::size_t nthreads, double surrogate_nsigma);
+RcppExport SEXP _movecon_Delayed_Acceptance_MH_From_GPS(SEXP eastingsSEXP, SEXP northingsSEXP, SEXP hdopsSEXP, SEXP uereSEXP, SEXP tSEXP, SEXP ntSEXP, SEXP statespaceSEXP, SEXP initial_latent_state_sampleSEXP, SEXP deltaSEXP, SEXP priorsSEXP, SEXP proposal_covarianceSEXP, SEXP initial_parametersSEXP, SEXP niterSEXP, SEXP coarseningSEXP, SEXP nthreadsSEXP, SEXP surrogate_nsigmaSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< /* likelihood components */     std::vector<double> >::type eastings(eastingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type northings(northingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type hdops(hdopsSEXP);
+    Rcpp::traits::input_parameter< double >::type uere(uereSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::size_t> >::type t(tSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nt(ntSEXP);
+    Rcpp::traits::input_parameter< /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<         std::vector<RookDirectionalStatespace::StateType*>     > >::type initial_latent_state_sample(initial_latent_state_sampleSEXP);
+    Rcpp::traits::input_parameter< double >::type delta(deltaSEXP);
+    Rcpp::traits::input_parameter< /* sampler components */     Rcpp::List >::type priors(priorsSEXP);
+    Rcpp::traits::input_parameter< Eigen::MatrixXd >::type proposal_covariance(proposal_covarianceSEXP);
+    Rcpp::traits::input_parameter< Eigen::MatrixXd >::type initial_parameters(initial_parametersSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type niter(niterSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type coarsening(coarseningSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nthreads(nthreadsSEXP);
+    Rcpp::traits::input_parameter< double >::type surrogate_nsigma(surrogate_nsigmaSEXP);
+    rcpp_result_gen = Rcpp::wrap(Delayed_Acceptance_MH_From_GPS(eastings, northings, hdops, uere, t, nt, statespace, initial_latent_state_sample, delta, priors, proposal_covariance, initial_parameters, niter, coarsening, nthreads, surrogate_nsigma));
+    return rcpp_result_gen;
+END_RCPP
+}
+// build_particle_count_tuner_from_gps
+Rcpp::XPtr<ParticleCountTuner> build_particle_count_tuner_from_gps(/* likelihood components */     std::vector<double> eastings, std::vector<double> northings, std::vector<double> hdops, double uere, std::vector<std::size_t> t, std::size_t nt, /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::XPtr<RookDirectionalStatespaceSearch> statespace_search, /* tuning components */     double target_variance, std::size_t nreplicates, std::size_t initial_particles, std::size_t max_particles);
+RcppExport SEXP _movecon_build_particle_count_tuner_from_gps(SEXP eastingsSEXP, SEXP northingsSEXP, SEXP hdopsSEXP, SEXP uereSEXP, SEXP tSEXP, SEXP ntSEXP, SEXP statespaceSEXP, SEXP statespace_searchSEXP, SEXP target_varianceSEXP, SEXP nreplicatesSEXP, SEXP initial_particlesSEXP, SEXP max_particlesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< /* likelihood components */     std::vector<double> >::type eastings(eastingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type northings(northingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type hdops(hdopsSEXP);
+    Rcpp::traits::input_parameter< double >::type uere(uereSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::size_t> >::type t(tSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nt(ntSEXP);
+    Rcpp::traits::input_parameter< /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr<RookDirectionalStatespaceSearch> >::type statespace_search(statespace_searchSEXP);
+    Rcpp::traits::input_parameter< /* tuning components */     double >::type target_variance(target_varianceSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nreplicates(nreplicatesSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type initial_particles(initial_particlesSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type max_particles(max_particlesSEXP);
+    rcpp_result_gen = Rcpp::wrap(build_particle_count_tuner_from_gps(eastings, northings, hdops, uere, t, nt, statespace, statespace_search, target_variance, nreplicates, initial_particles, max_particles));
+    return rcpp_result_gen;
+END_RCPP
+}
+// tune_particle_count
+Rcpp::List tune_particle_count(Rcpp::XPtr<ParticleCountTuner> tuner, /* model parameters */     double directional_persistence, Eigen::VectorXd beta, double delta, std::size_t nthreads);
+RcppExport SEXP _movecon_tune_particle_count(SEXP tunerSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP deltaSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<ParticleCountTuner> >::type tuner(tunerSEXP);
+    Rcpp::traits::input_parameter< /* model parameters */     double >::type directional_persistence(directional_persistenceSEXP);
+    Rcpp::traits::input_parameter< Eigen::VectorXd >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< double >::type delta(deltaSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(tune_particle_count(tuner, directional_persistence, beta, delta, nthreads));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -232,6 +803,222 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// sample_discretized_gaussian_states
+Rcpp::List sample_discretized_gaussian_states(Rcpp::XPtr<RookDirectionalStatespaceSearch> statespace_search, double easting, double northing, double semi_major, double semi_minor, double orientation, std::size_t n, double nsigma);
+RcppExport SEXP _movecon_sample_discretized_gaussian_states(SEXP statespace_searchSEXP, SEXP eastingSEXP, SEXP northingSEXP, SEXP semi_majorSEXP, SEXP semi_minorSEXP, SEXP orientationSEXP, SEXP nSEXP, SEXP nsigmaSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<RookDirectionalStatespaceSearch> >::type statespace_search(statespace_searchSEXP);
+    Rcpp::traits::input_parameter< double >::type easting(eastingSEXP);
+    Rcpp::traits::input_parameter< double >::type northing(northingSEXP);
+    Rcpp::traits::input_parameter< double >::type semi_major(semi_majorSEXP);
+    Rcpp::traits::input_parameter< double >::type semi_minor(semi_minorSEXP);
+    Rcpp::traits::input_parameter< double >::type orientation(orientationSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n(nSEXP);
+    Rcpp::traits::input_parameter< double >::type nsigma(nsigmaSEXP);
+    rcpp_result_gen = Rcpp::wrap(sample_discretized_gaussian_states(statespace_search, easting, northing, semi_major, semi_minor, orientation, n, nsigma));
+    return rcpp_result_gen;
+END_RCPP
+}
+// sample_discretized_gaussian_states_from_hdop_uere
+Rcpp::List sample_discretized_gaussian_states_from_hdop_uere(Rcpp::XPtr<RookDirectionalStatespaceSearch> statespace_search, double easting, double northing, double hdop, double uere, std::size_t n, double nsigma);
+RcppExport SEXP _movecon_sample_discretized_gaussian_states_from_hdop_uere(SEXP statespace_searchSEXP, SEXP eastingSEXP, SEXP northingSEXP, SEXP hdopSEXP, SEXP uereSEXP, SEXP nSEXP, SEXP nsigmaSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<RookDirectionalStatespaceSearch> >::type statespace_search(statespace_searchSEXP);
+    Rcpp::traits::input_parameter< double >::type easting(eastingSEXP);
+    Rcpp::traits::input_parameter< double >::type northing(northingSEXP);
+    Rcpp::traits::input_parameter< double >::type hdop(hdopSEXP);
+    Rcpp::traits::input_parameter< double >::type uere(uereSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n(nSEXP);
+    Rcpp::traits::input_parameter< double >::type nsigma(nsigmaSEXP);
+    rcpp_result_gen = Rcpp::wrap(sample_discretized_gaussian_states_from_hdop_uere(statespace_search, easting, northing, hdop, uere, n, nsigma));
+    return rcpp_result_gen;
+END_RCPP
+}
+// build_reachability_from_gps
+Rcpp::XPtr<RookDirectionalReachability> build_reachability_from_gps(Rcpp::XPtr<RookDirectionalStatespaceSearch> statespace_search, std::vector<double> eastings, std::vector<double> northings, std::vector<double> hdops, double uere, std::vector<std::size_t> t, std::size_t nt, double nsigma);
+RcppExport SEXP _movecon_build_reachability_from_gps(SEXP statespace_searchSEXP, SEXP eastingsSEXP, SEXP northingsSEXP, SEXP hdopsSEXP, SEXP uereSEXP, SEXP tSEXP, SEXP ntSEXP, SEXP nsigmaSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<RookDirectionalStatespaceSearch> >::type statespace_search(statespace_searchSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type eastings(eastingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type northings(northingsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type hdops(hdopsSEXP);
+    Rcpp::traits::input_parameter< double >::type uere(uereSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::size_t> >::type t(tSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nt(ntSEXP);
+    Rcpp::traits::input_parameter< double >::type nsigma(nsigmaSEXP);
+    rcpp_result_gen = Rcpp::wrap(build_reachability_from_gps(statespace_search, eastings, northings, hdops, uere, t, nt, nsigma));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Test__Reachability_Field_Sizes
+std::vector<std::size_t> Test__Reachability_Field_Sizes(Rcpp::XPtr<RookDirectionalReachability> reachability);
+RcppExport SEXP _movecon_Test__Reachability_Field_Sizes(SEXP reachabilitySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<RookDirectionalReachability> >::type reachability(reachabilitySEXP);
+    rcpp_result_gen = Rcpp::wrap(Test__Reachability_Field_Sizes(reachability));
+    return rcpp_result_gen;
+END_RCPP
+}
+// simulate_trajectories
+Rcpp::List simulate_trajectories(Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::IntegerVector state_ids, /* model parameters */     double directional_persistence, Eigen::VectorXd beta, double delta, /* simulation components */     std::size_t nsteps, std::size_t nthreads, bool coordinates);
+RcppExport SEXP _movecon_simulate_trajectories(SEXP statespaceSEXP, SEXP state_idsSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP deltaSEXP, SEXP nstepsSEXP, SEXP nthreadsSEXP, SEXP coordinatesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type state_ids(state_idsSEXP);
+    Rcpp::traits::input_parameter< /* model parameters */     double >::type directional_persistence(directional_persistenceSEXP);
+    Rcpp::traits::input_parameter< Eigen::VectorXd >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< double >::type delta(deltaSEXP);
+    Rcpp::traits::input_parameter< /* simulation components */     std::size_t >::type nsteps(nstepsSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nthreads(nthreadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type coordinates(coordinatesSEXP);
+    rcpp_result_gen = Rcpp::wrap(simulate_trajectories(statespace, state_ids, directional_persistence, beta, delta, nsteps, nthreads, coordinates));
+    return rcpp_result_gen;
+END_RCPP
+}
+// simulate_trajectories_gillespie
+Rcpp::List simulate_trajectories_gillespie(Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::IntegerVector state_ids, /* model parameters */     double directional_persistence, Eigen::VectorXd beta, /* simulation components */     std::vector<double> times, std::size_t nthreads, bool coordinates);
+RcppExport SEXP _movecon_simulate_trajectories_gillespie(SEXP statespaceSEXP, SEXP state_idsSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP timesSEXP, SEXP nthreadsSEXP, SEXP coordinatesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type state_ids(state_idsSEXP);
+    Rcpp::traits::input_parameter< /* model parameters */     double >::type directional_persistence(directional_persistenceSEXP);
+    Rcpp::traits::input_parameter< Eigen::VectorXd >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< /* simulation components */     std::vector<double> >::type times(timesSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nthreads(nthreadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type coordinates(coordinatesSEXP);
+    rcpp_result_gen = Rcpp::wrap(simulate_trajectories_gillespie(statespace, state_ids, directional_persistence, beta, times, nthreads, coordinates));
+    return rcpp_result_gen;
+END_RCPP
+}
+// simulate_trajectories_to_file
+double simulate_trajectories_to_file(Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::IntegerVector state_ids, /* model parameters */     double directional_persistence, Eigen::VectorXd beta, double delta, /* simulation components */     std::size_t nsteps, std::string path, std::size_t chunk_size);
+RcppExport SEXP _movecon_simulate_trajectories_to_file(SEXP statespaceSEXP, SEXP state_idsSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP deltaSEXP, SEXP nstepsSEXP, SEXP pathSEXP, SEXP chunk_sizeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type state_ids(state_idsSEXP);
+    Rcpp::traits::input_parameter< /* model parameters */     double >::type directional_persistence(directional_persistenceSEXP);
+    Rcpp::traits::input_parameter< Eigen::VectorXd >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< double >::type delta(deltaSEXP);
+    Rcpp::traits::input_parameter< /* simulation components */     std::size_t >::type nsteps(nstepsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type chunk_size(chunk_sizeSEXP);
+    rcpp_result_gen = Rcpp::wrap(simulate_trajectories_to_file(statespace, state_ids, directional_persistence, beta, delta, nsteps, path, chunk_size));
+    return rcpp_result_gen;
+END_RCPP
+}
+// simulate_trajectories_gillespie_to_file
+double simulate_trajectories_gillespie_to_file(Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::IntegerVector state_ids, /* model parameters */     double directional_persistence, Eigen::VectorXd beta, /* simulation components */     double duration, std::string path, std::size_t chunk_size);
+RcppExport SEXP _movecon_simulate_trajectories_gillespie_to_file(SEXP statespaceSEXP, SEXP state_idsSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP durationSEXP, SEXP pathSEXP, SEXP chunk_sizeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type state_ids(state_idsSEXP);
+    Rcpp::traits::input_parameter< /* model parameters */     double >::type directional_persistence(directional_persistenceSEXP);
+    Rcpp::traits::input_parameter< Eigen::VectorXd >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< /* simulation components */     double >::type duration(durationSEXP);
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type chunk_size(chunk_sizeSEXP);
+    rcpp_result_gen = Rcpp::wrap(simulate_trajectories_gillespie_to_file(statespace, state_ids, directional_persistence, beta, duration, path, chunk_size));
+    return rcpp_result_gen;
+END_RCPP
+}
+// sample_smoothed_paths
+Rcpp::List sample_smoothed_paths(Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::IntegerMatrix state_ids, /* model parameters */     double directional_persistence, Eigen::VectorXd beta, double delta, /* sampling components */     std::size_t npaths, std::size_t nthreads);
+RcppExport SEXP _movecon_sample_smoothed_paths(SEXP statespaceSEXP, SEXP state_idsSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP deltaSEXP, SEXP npathsSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerMatrix >::type state_ids(state_idsSEXP);
+    Rcpp::traits::input_parameter< /* model parameters */     double >::type directional_persistence(directional_persistenceSEXP);
+    Rcpp::traits::input_parameter< Eigen::VectorXd >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< double >::type delta(deltaSEXP);
+    Rcpp::traits::input_parameter< /* sampling components */     std::size_t >::type npaths(npathsSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(sample_smoothed_paths(statespace, state_ids, directional_persistence, beta, delta, npaths, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// Batch_Particle_Filter_Likelihood_From_GPS
+Rcpp::List Batch_Particle_Filter_Likelihood_From_GPS(/* likelihood components */     Rcpp::List tracks, double uere, /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> statespace, Rcpp::List initial_latent_state_samples, /* model parameters */     double directional_persistence, Eigen::VectorXd beta, double delta, /* computational settings */     std::size_t nthreads);
+RcppExport SEXP _movecon_Batch_Particle_Filter_Likelihood_From_GPS(SEXP tracksSEXP, SEXP uereSEXP, SEXP statespaceSEXP, SEXP initial_latent_state_samplesSEXP, SEXP directional_persistenceSEXP, SEXP betaSEXP, SEXP deltaSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< /* likelihood components */     Rcpp::List >::type tracks(tracksSEXP);
+    Rcpp::traits::input_parameter< double >::type uere(uereSEXP);
+    Rcpp::traits::input_parameter< /* filter components */     Rcpp::XPtr<RookDirectionalStatespace> >::type statespace(statespaceSEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type initial_latent_state_samples(initial_latent_state_samplesSEXP);
+    Rcpp::traits::input_parameter< /* model parameters */     double >::type directional_persistence(directional_persistenceSEXP);
+    Rcpp::traits::input_parameter< Eigen::VectorXd >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< double >::type delta(deltaSEXP);
+    Rcpp::traits::input_parameter< /* computational settings */     std::size_t >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(Batch_Particle_Filter_Likelihood_From_GPS(tracks, uere, statespace, initial_latent_state_samples, directional_persistence, beta, delta, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// open_trajectory_file
+Rcpp::XPtr<TrajectoryFileReader> open_trajectory_file(std::string path);
+RcppExport SEXP _movecon_open_trajectory_file(SEXP pathSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    rcpp_result_gen = Rcpp::wrap(open_trajectory_file(path));
+    return rcpp_result_gen;
+END_RCPP
+}
+// trajectory_file_summary
+Rcpp::List trajectory_file_summary(Rcpp::XPtr<TrajectoryFileReader> reader);
+RcppExport SEXP _movecon_trajectory_file_summary(SEXP readerSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<TrajectoryFileReader> >::type reader(readerSEXP);
+    rcpp_result_gen = Rcpp::wrap(trajectory_file_summary(reader));
+    return rcpp_result_gen;
+END_RCPP
+}
+// read_trajectory
+Rcpp::List read_trajectory(Rcpp::XPtr<TrajectoryFileReader> reader, std::size_t path);
+RcppExport SEXP _movecon_read_trajectory(SEXP readerSEXP, SEXP pathSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<TrajectoryFileReader> >::type reader(readerSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type path(pathSEXP);
+    rcpp_result_gen = Rcpp::wrap(read_trajectory(reader, path));
+    return rcpp_result_gen;
+END_RCPP
+}
+// read_trajectory_records
+Rcpp::List read_trajectory_records(Rcpp::XPtr<TrajectoryFileReader> reader, std::size_t first, std::size_t n);
+RcppExport SEXP _movecon_read_trajectory_records(SEXP readerSEXP, SEXP firstSEXP, SEXP nSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<TrajectoryFileReader> >::type reader(readerSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type first(firstSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n(nSEXP);
+    rcpp_result_gen = Rcpp::wrap(read_trajectory_records(reader, first, n));
+    return rcpp_result_gen;
+END_RCPP
+}
 // Test__Directional_Transition_Probabilities
 Eigen::VectorXd Test__Directional_Transition_Probabilities(Rcpp::XPtr<RookDirectionalStatespace> statespace, std::string last_movement_direction, std::size_t easting_ind, std::size_t northing_ind, double directional_persistence);
 RcppExport SEXP _movecon_Test__Directional_Transition_Probabilities(SEXP statespaceSEXP, SEXP last_movement_directionSEXP, SEXP easting_indSEXP, SEXP northing_indSEXP, SEXP directional_persistenceSEXP) {
@@ -287,19 +1074,67 @@ END_RCPP
 
 static const R_CallMethodDef CallEntries[] = {
     {"_movecon_Test__AppliedLikelihoodFamily", (DL_FUNC) &_movecon_Test__AppliedLikelihoodFamily, 8},
+    {"_movecon_Test__AppliedLikelihoodFamilyFromGPS", (DL_FUNC) &_movecon_Test__AppliedLikelihoodFamilyFromGPS, 7},
+    {"_movecon_build_covariate_stack", (DL_FUNC) &_movecon_build_covariate_stack, 4},
+    {"_movecon_covariate_stack_rates", (DL_FUNC) &_movecon_covariate_stack_rates, 4},
+    {"_movecon_build_directional_bias", (DL_FUNC) &_movecon_build_directional_bias, 2},
+    {"_movecon_directional_bias_probabilities", (DL_FUNC) &_movecon_directional_bias_probabilities, 3},
     {"_movecon_Test__Directional_Covariate", (DL_FUNC) &_movecon_Test__Directional_Covariate, 2},
     {"_movecon_build_statespace", (DL_FUNC) &_movecon_build_statespace, 4},
+    {"_movecon_build_coarse_statespace", (DL_FUNC) &_movecon_build_coarse_statespace, 2},
+    {"_movecon_statespace_state_locations", (DL_FUNC) &_movecon_statespace_state_locations, 1},
+    {"_movecon_state_sample_ids", (DL_FUNC) &_movecon_state_sample_ids, 1},
     {"_movecon_extract_statespace_location", (DL_FUNC) &_movecon_extract_statespace_location, 3},
     {"_movecon_extract_statespace_state", (DL_FUNC) &_movecon_extract_statespace_state, 4},
+    {"_movecon_statespace_columns", (DL_FUNC) &_movecon_statespace_columns, 1},
     {"_movecon_build_statespace_search", (DL_FUNC) &_movecon_build_statespace_search, 1},
     {"_movecon_nearest_location_in_domain", (DL_FUNC) &_movecon_nearest_location_in_domain, 3},
     {"_movecon_states_at_nearest_location_in_domain", (DL_FUNC) &_movecon_states_at_nearest_location_in_domain, 3},
+    {"_movecon_nearest_locations_in_domain", (DL_FUNC) &_movecon_nearest_locations_in_domain, 4},
+    {"_movecon_statespace_search_locations", (DL_FUNC) &_movecon_statespace_search_locations, 1},
+    {"_movecon_build_checkpointed_filter_from_gps", (DL_FUNC) &_movecon_build_checkpointed_filter_from_gps, 11},
+    {"_movecon_checkpointed_filter_run", (DL_FUNC) &_movecon_checkpointed_filter_run, 3},
+    {"_movecon_checkpointed_filter_resume", (DL_FUNC) &_movecon_checkpointed_filter_resume, 2},
+    {"_movecon_read_state_id_file", (DL_FUNC) &_movecon_read_state_id_file, 1},
+    {"_movecon_build_filter_session_from_gps", (DL_FUNC) &_movecon_build_filter_session_from_gps, 8},
+    {"_movecon_filter_session_loglik", (DL_FUNC) &_movecon_filter_session_loglik, 6},
+    {"_movecon_filter_session_truncated", (DL_FUNC) &_movecon_filter_session_truncated, 1},
+    {"_movecon_build_fixed_lag_smoother", (DL_FUNC) &_movecon_build_fixed_lag_smoother, 7},
+    {"_movecon_fixed_lag_smoother_append_observation", (DL_FUNC) &_movecon_fixed_lag_smoother_append_observation, 5},
+    {"_movecon_fixed_lag_smoother_smoothed_at", (DL_FUNC) &_movecon_fixed_lag_smoother_smoothed_at, 2},
+    {"_movecon_Particle_Filter_Likelihood_From_GPS_Parameter_Batch", (DL_FUNC) &_movecon_Particle_Filter_Likelihood_From_GPS_Parameter_Batch, 11},
     {"_movecon_Test__Particle_Steps", (DL_FUNC) &_movecon_Test__Particle_Steps, 8},
     {"_movecon_Test__Particle_Filter_Likelihood", (DL_FUNC) &_movecon_Test__Particle_Filter_Likelihood, 12},
     {"_movecon_Particle_Filter_Likelihood_From_GPS", (DL_FUNC) &_movecon_Particle_Filter_Likelihood_From_GPS, 11},
-    {"_movecon_Test__Particle_Gillespie_Steps", (DL_FUNC) &_movecon_Test__Particle_Gillespie_Steps, 8},
+    {"_movecon_Particle_Filter_Likelihood_From_GPS_With_Reachability", (DL_FUNC) &_movecon_Particle_Filter_Likelihood_From_GPS_With_Reachability, 13},
+    {"_movecon_Particle_Filter_Likelihood_From_GPS_With_Lookahead", (DL_FUNC) &_movecon_Particle_Filter_Likelihood_From_GPS_With_Lookahead, 12},
+    {"_movecon_Particle_Filter_Likelihood_From_GPS_Gillespie", (DL_FUNC) &_movecon_Particle_Filter_Likelihood_From_GPS_Gillespie, 9},
+    {"_movecon_Particle_Filter_Likelihood_From_GPS_Time_Varying", (DL_FUNC) &_movecon_Particle_Filter_Likelihood_From_GPS_Time_Varying, 12},
+    {"_movecon_Particle_Filter_Likelihood_From_GPS_With_Directional_Bias", (DL_FUNC) &_movecon_Particle_Filter_Likelihood_From_GPS_With_Directional_Bias, 13},
+    {"_movecon_Particle_Filter_State_Ids_From_GPS", (DL_FUNC) &_movecon_Particle_Filter_State_Ids_From_GPS, 12},
+    {"_movecon_Particle_Filter_State_Ids_To_File_From_GPS", (DL_FUNC) &_movecon_Particle_Filter_State_Ids_To_File_From_GPS, 13},
+    {"_movecon_Particle_Filter_Occupancy_From_GPS", (DL_FUNC) &_movecon_Particle_Filter_Occupancy_From_GPS, 13},
+    {"_movecon_Test__Particle_Gillespie_Steps", (DL_FUNC) &_movecon_Test__Particle_Gillespie_Steps, 7},
+    {"_movecon_Particle_Marginal_MH_From_GPS", (DL_FUNC) &_movecon_Particle_Marginal_MH_From_GPS, 15},
+    {"_movecon_Delayed_Acceptance_MH_From_GPS", (DL_FUNC) &_movecon_Delayed_Acceptance_MH_From_GPS, 16},
+    {"_movecon_build_particle_count_tuner_from_gps", (DL_FUNC) &_movecon_build_particle_count_tuner_from_gps, 12},
+    {"_movecon_tune_particle_count", (DL_FUNC) &_movecon_tune_particle_count, 5},
     {"_movecon_sample_gaussian_states", (DL_FUNC) &_movecon_sample_gaussian_states, 7},
     {"_movecon_sample_gaussian_states_from_hdop_uere", (DL_FUNC) &_movecon_sample_gaussian_states_from_hdop_uere, 6},
+    {"_movecon_sample_discretized_gaussian_states", (DL_FUNC) &_movecon_sample_discretized_gaussian_states, 8},
+    {"_movecon_sample_discretized_gaussian_states_from_hdop_uere", (DL_FUNC) &_movecon_sample_discretized_gaussian_states_from_hdop_uere, 7},
+    {"_movecon_build_reachability_from_gps", (DL_FUNC) &_movecon_build_reachability_from_gps, 8},
+    {"_movecon_Test__Reachability_Field_Sizes", (DL_FUNC) &_movecon_Test__Reachability_Field_Sizes, 1},
+    {"_movecon_simulate_trajectories", (DL_FUNC) &_movecon_simulate_trajectories, 8},
+    {"_movecon_simulate_trajectories_gillespie", (DL_FUNC) &_movecon_simulate_trajectories_gillespie, 7},
+    {"_movecon_simulate_trajectories_to_file", (DL_FUNC) &_movecon_simulate_trajectories_to_file, 8},
+    {"_movecon_simulate_trajectories_gillespie_to_file", (DL_FUNC) &_movecon_simulate_trajectories_gillespie_to_file, 7},
+    {"_movecon_sample_smoothed_paths", (DL_FUNC) &_movecon_sample_smoothed_paths, 7},
+    {"_movecon_Batch_Particle_Filter_Likelihood_From_GPS", (DL_FUNC) &_movecon_Batch_Particle_Filter_Likelihood_From_GPS, 8},
+    {"_movecon_open_trajectory_file", (DL_FUNC) &_movecon_open_trajectory_file, 1},
+    {"_movecon_trajectory_file_summary", (DL_FUNC) &_movecon_trajectory_file_summary, 1},
+    {"_movecon_read_trajectory", (DL_FUNC) &_movecon_read_trajectory, 2},
+    {"_movecon_read_trajectory_records", (DL_FUNC) &_movecon_read_trajectory_records, 3},
     {"_movecon_Test__Directional_Transition_Probabilities", (DL_FUNC) &_movecon_Test__Directional_Transition_Probabilities, 5},
     {"_movecon_Test__Location_Based_Movement_Transition_Rate", (DL_FUNC) &_movecon_Test__Location_Based_Movement_Transition_Rate, 5},
     {"_movecon_log_sum", (DL_FUNC) &_movecon_log_sum, 1},
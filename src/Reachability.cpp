@@ -0,0 +1,107 @@
+#include "Reachability.h"
+#include "DomainSearch.h"
+#include "ProjectedLocationLikelihood.h"
+
+/**
+ * Build hop distance fields for a sequence of GPS observations.
+ *
+ * The support of each observation's likelihood is the set of states whose 
+ * locations lie within the nsigma-contour of the observation distribution, 
+ * i.e., for observation errors truncated to the contour.  An observation 
+ * whose contour does not contain any states has an empty support, so filters 
+ * that use the fields will return a likelihood of 0.  Hop distances are only 
+ * computed out to the number of steps between consecutive observations.
+ *
+ * @param t vector of discrete time indices (starting at 0) at which
+ *   observations are available
+ * @param nt total number of discrete timepoints
+ * @param nsigma size of the contour used to define each observation's support
+*/
+// [[Rcpp::export]]
+Rcpp::XPtr<RookDirectionalReachability> build_reachability_from_gps(
+    Rcpp::XPtr<RookDirectionalStatespaceSearch> statespace_search,
+    std::vector<double> eastings, std::vector<double> northings,
+    std::vector<double> hdops, double uere, std::vector<std::size_t> t,
+    std::size_t nt, double nsigma
+) {
+
+    typedef RookDirectionalStatespace::StateType StateType;
+
+    RookDirectionalReachability * reachability =
+        new RookDirectionalReachability();
+    reachability->observation_times = t;
+    reachability->nt = nt;
+    reachability->nsigma = nsigma;
+    reachability->fields.reserve(t.size());
+
+    std::vector<Location*> locations;
+    std::vector<const StateType*> targets;
+
+    auto eastings_it = eastings.begin();
+    auto northings_it = northings.begin();
+    auto hdops_it = hdops.begin();
+
+    // particles take t[0] + 1 steps before the first observation
+    std::size_t t_prev = 0;
+    std::size_t max_hops = t.empty() ? 0 : t[0];
+
+    for(auto t_it = t.begin(); t_it != t.end(); ++t_it) {
+
+        if(t_it != t.begin()) {
+            max_hops = *t_it - t_prev - 1;
+        }
+        t_prev = *t_it;
+
+        ProjectedLocationLikelihood lik =
+            ProjectedLocationLikelihood::from_hdop_uere(
+                *eastings_it, *northings_it, *hdops_it, uere
+            );
+
+        // locations near the observation
+        double min_easting, min_northing, max_easting, max_northing;
+        lik.bounding_box(
+            nsigma, min_easting, min_northing, max_easting, max_northing
+        );
+        locations.clear();
+        statespace_search->map_box(
+            min_easting, min_northing, max_easting, max_northing,
+            std::back_inserter(locations)
+        );
+
+        // states within the observation's support
+        targets.clear();
+        for(auto location : locations) {
+            for(auto state : statespace_search->states_at(location)) {
+                if(lik.within(*state, nsigma)) {
+                    targets.push_back(state);
+                }
+            }
+        }
+
+        reachability->fields.emplace_back(
+            targets.begin(), targets.end(), max_hops
+        );
+
+        ++eastings_it;
+        ++northings_it;
+        ++hdops_it;
+    }
+
+    return Rcpp::XPtr<RookDirectionalReachability>(reachability, true);
+}
+
+/**
+ * Number of states from which each observation's support can be reached in
+ * the time available before the observation
+*/
+// [[Rcpp::export]]
+std::vector<std::size_t> Test__Reachability_Field_Sizes(
+    Rcpp::XPtr<RookDirectionalReachability> reachability
+) {
+    std::vector<std::size_t> res;
+    res.reserve(reachability->fields.size());
+    for(auto & field : reachability->fields) {
+        res.push_back(field.size());
+    }
+    return res;
+}
@@ -0,0 +1,195 @@
+/**
+ * Objects that describe which states can reach the support of upcoming
+ * observations, and proposal distributions that use this information to
+ * avoid propagating particles that will receive zero weight
+*/
+
+#ifndef MOVECON_REACHABILITY_H
+#define MOVECON_REACHABILITY_H
+
+#include <Rcpp.h>
+
+#include <deque>
+#include <unordered_map>
+
+#include "Domain.h"
+
+/**
+ * Minimum number of transitions needed to reach a set of target states,
+ * computed via breadth-first search over the backward links between states.
+ * Distances are only stored for states that can reach the target set within
+ * a maximum number of transitions.
+*/
+template<typename StateType>
+class HopDistanceField {
+
+    private:
+
+        std::unordered_map<const StateType*, std::size_t> hops;
+
+    public:
+
+        /**
+         * @param target_begin iterator to the first target state pointer
+         * @param target_end iterator past the last target state pointer
+         * @param max_hops largest distance to store
+        */
+        template<typename Iterator>
+        HopDistanceField(
+            Iterator target_begin, Iterator target_end, std::size_t max_hops
+        ) {
+            // target states are 0 hops away from the target set
+            std::deque<const StateType*> queue;
+            for(; target_begin != target_end; ++target_begin) {
+                if(hops.emplace(*target_begin, 0).second) {
+                    queue.push_back(*target_begin);
+                }
+            }
+            // states are first visited along their shortest path to the target
+            while(!queue.empty()) {
+                const StateType * state = queue.front();
+                queue.pop_front();
+                std::size_t source_hops = hops.find(state)->second + 1;
+                if(source_hops > max_hops) {
+                    continue;
+                }
+                for(auto source : state->from) {
+                    if(hops.emplace(source, source_hops).second) {
+                        queue.push_back(source);
+                    }
+                }
+            }
+        }
+
+        /**
+         * Determine if the target set can be reached from a state in at most
+         * nsteps transitions
+        */
+        bool reachable(const StateType & state, std::size_t nsteps) const {
+            auto search = hops.find(&state);
+            return search != hops.end() && search->second <= nsteps;
+        }
+
+        std::size_t size() const {
+            return hops.size();
+        }
+
+};
+
+/**
+ * Proposal distribution that accounts for whether particles can reach the
+ * support of the next observation's likelihood in the remaining number of
+ * steps before the observation.
+ *
+ * Pruning proposals simulate from the bootstrap proposal, then zero-out the
+ * weights of particles that can no longer reach the next observation.  Guided
+ * proposals simulate from the transition distribution restricted to states
+ * that can still reach the next observation, and reweight particles by the
+ * transition mass retained by the restriction.  Both variants only discard 
+ * particles that would receive zero weight, so they yield unbiased estimates 
+ * of the likelihood if the likelihood vanishes outside of the support used to 
+ * build the HopDistanceField objects, e.g., for observation errors that are 
+ * truncated to the support via AppliedTruncatedLocationLikelihood objects.
+*/
+template<typename Particle, typename StateType>
+class ReachabilityProposal {
+
+    private:
+
+        const HopDistanceField<StateType> * field;
+        std::size_t steps_remaining;
+        bool guided;
+
+        // log-potential that restricts transitions to reachable states
+        struct ReachablePotential {
+            const HopDistanceField<StateType> * field;
+            std::size_t steps_remaining;
+            double operator()(const StateType & state) {
+                return field->reachable(state, steps_remaining) ? 0 : R_NegInf;
+            }
+        };
+
+    public:
+
+        /**
+         * @param distances hop distances to the support of the next
+         *   observation, or nullptr if there are no more observations
+         * @param nsteps number of steps that will remain before the next
+         *   observation after the proposal is made
+         * @param guide true to use the guided proposal, false to prune
+        */
+        ReachabilityProposal(
+            const HopDistanceField<StateType> * distances, std::size_t nsteps,
+            bool guide
+        ) : field(distances), steps_remaining(nsteps), guided(guide) { }
+
+        double propose(Particle & particle) {
+            if(field == nullptr) {
+                particle.step();
+                return 0;
+            }
+            if(guided) {
+                ReachablePotential potential{field, steps_remaining};
+                return particle.twisted_step(potential);
+            }
+            particle.step();
+            return field->reachable(*particle.state, steps_remaining) ?
+                0 : R_NegInf;
+        }
+
+};
+
+/**
+ * Hop distance fields for the support of each observation in a sequence of
+ * observations made at discrete time indices
+*/
+template<typename StateType>
+struct ObservationReachability {
+
+    // discrete time indices (starting at 0) at which observations are made
+    std::vector<std::size_t> observation_times;
+
+    // total number of discrete timepoints
+    std::size_t nt;
+
+    // size of the contour that defines each observation's support
+    double nsigma;
+
+    // hop distances to the support of each observation
+    std::vector<HopDistanceField<StateType>> fields;
+
+    /**
+     * Create one proposal distribution for each discrete timepoint
+     *
+     * @param guided true to use guided proposals, false to prune particles
+    */
+    template<typename Particle>
+    std::vector<ReachabilityProposal<Particle, StateType>> proposals(
+        bool guided
+    ) const {
+        std::vector<ReachabilityProposal<Particle, StateType>> family;
+        family.reserve(nt);
+        auto t_it = observation_times.begin();
+        auto t_end = observation_times.end();
+        auto field = fields.begin();
+        for(std::size_t ind = 0; ind < nt; ++ind) {
+            // advance to the next observation
+            if(t_it != t_end && *t_it < ind) {
+                ++t_it;
+                ++field;
+            }
+            if(t_it == t_end) {
+                family.emplace_back(nullptr, 0, guided);
+            } else {
+                family.emplace_back(&(*field), *t_it - ind, guided);
+            }
+        }
+        return family;
+    }
+
+};
+
+typedef ObservationReachability<RookDirectionalStatespace::StateType>
+    RookDirectionalReachability;
+
+#endif
@@ -0,0 +1,301 @@
+#include "Simulation.h"
+
+#include "ThreadPool.h"
+#include "TrajectoryFile.h"
+
+#include <algorithm>
+
+TrajectorySimulator::TrajectorySimulator(
+    RookDirectionalStatespace & statespace, double directional_persistence,
+    const Eigen::Ref<const Eigen::VectorXd> & beta_init, double delta
+) : states(statespace.states.size()), beta(beta_init),
+    location_based_rate(beta), uniformized_rate(&location_based_rate, delta),
+    transition_rate(uniformized_rate),
+    directional_probs(directional_persistence),
+    transition_prob(directional_probs) {
+
+    if(states.empty()) {
+        Rcpp::stop("Argument statespace must not be empty");
+    }
+    std::size_t npar =
+        statespace.states.begin()->second.properties.location->x.size();
+    if(static_cast<std::size_t>(beta.size()) != npar) {
+        Rcpp::stop("Argument beta has the wrong length");
+    }
+
+    for(auto & map_entry : statespace.states) {
+        states[map_entry.second.index] = &map_entry.second;
+    }
+
+    // cache transition rates and probabilities for all states, so that
+    // trajectories may be simulated in parallel
+    statespace.reset_transition_cache();
+    statespace.prime_transition_cache(transition_rate, transition_prob);
+}
+
+void TrajectorySimulator::simulate_steps(
+    std::size_t start, std::size_t nsteps, StreamRandom & rng,
+    std::uint32_t * path
+) {
+    auto sink = [path](double time, std::uint32_t state_id) {
+        path[static_cast<std::size_t>(time)] = state_id;
+    };
+    simulate_steps(start, nsteps, rng, sink);
+}
+
+void TrajectorySimulator::simulate_times(
+    std::size_t start, const std::vector<double> & times, StreamRandom & rng,
+    std::uint32_t * path
+) {
+    if(times.empty()) {
+        return;
+    }
+    GillespieParticleType particle(location_based_rate, transition_prob, rng);
+    particle.state = states[start];
+    path[0] = start;
+    for(std::size_t i = 1; i < times.size(); ++i) {
+        particle.step(times[i - 1], times[i]);
+        path[i] = particle.state->index;
+    }
+}
+
+/**
+ * Draw one random number stream for each trajectory on the main thread, so 
+ * that trajectories do not depend on how they are scheduled or stored
+*/
+std::vector<StreamRandom> trajectory_streams(std::size_t npaths) {
+    std::vector<StreamRandom> streams;
+    streams.reserve(npaths);
+    if(npaths > 0) {
+        streams.push_back(StreamRandom::from_r());
+    }
+    for(std::size_t i = 1; i < npaths; ++i) {
+        streams.push_back(streams.back().split());
+    }
+    return streams;
+}
+
+/**
+ * Simulate trajectories in parallel, with one random number stream for each
+ * trajectory, and export them as state ids or coordinates
+ *
+ * @param simulate function object that simulates a trajectory given its
+ *   starting state id, random number stream, and output, i.e., to call
+ *   TrajectorySimulator::simulate_steps
+*/
+template<typename Simulate>
+Rcpp::List simulate_trajectories_impl(
+    TrajectorySimulator & simulator, const Rcpp::IntegerVector & state_ids,
+    std::size_t nt, std::size_t nthreads, bool coordinates,
+    Simulate & simulate
+) {
+
+    std::size_t npaths = state_ids.size();
+    for(std::size_t i = 0; i < npaths; ++i) {
+        if(state_ids[i] < 0 ||
+           static_cast<std::size_t>(state_ids[i]) >= simulator.size()) {
+            Rcpp::stop("State ids must belong to the statespace");
+        }
+    }
+
+    std::vector<StreamRandom> streams = trajectory_streams(npaths);
+
+    // simulate trajectories in parallel
+    std::vector<std::uint32_t> paths(nt * npaths);
+    auto simulate_path = [&](std::size_t i) {
+        simulate(state_ids[i], streams[i], paths.data() + i * nt);
+    };
+    WorkStealingPool pool(nthreads);
+    pool.run(std::vector<double>(npaths, 1), simulate_path);
+
+    // export trajectories
+    if(coordinates) {
+        Rcpp::NumericMatrix eastings(nt, npaths);
+        Rcpp::NumericMatrix northings(nt, npaths);
+        for(std::size_t k = 0; k < nt * npaths; ++k) {
+            const Location * location =
+                simulator.state(paths[k])->properties.location;
+            eastings[k] = location->easting;
+            northings[k] = location->northing;
+        }
+        return Rcpp::List::create(
+            Rcpp::Named("easting") = eastings,
+            Rcpp::Named("northing") = northings
+        );
+    }
+    Rcpp::IntegerMatrix path_ids(nt, npaths);
+    std::copy(paths.begin(), paths.end(), path_ids.begin());
+    return Rcpp::List::create(Rcpp::Named("state_ids") = path_ids);
+}
+
+/**
+ * Simulate many trajectories in discrete time via the uniformized transition
+ * distribution, i.e., the batch version of \code{Test__Particle_Steps}.
+ *
+ * Each trajectory uses its own random number stream, so results do not
+ * depend on the number of threads.
+ *
+ * @param statespace Object constructed from \code{build_statespace}
+ * @param state_ids 0-based ids of the starting state for each trajectory,
+ *   as in \code{statespace_state_locations}
+ * @param nsteps number of steps to simulate
+ * @param nthreads number of threads to use
+ * @param coordinates TRUE to return coordinates rather than state ids
+ * @return list with a matrix of state ids, or matrices of eastings and
+ *   northings, with nsteps + 1 rows, including the starting states, and one
+ *   column for each trajectory
+*/
+// [[Rcpp::export]]
+Rcpp::List simulate_trajectories(
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::IntegerVector state_ids,
+    /* model parameters */
+    double directional_persistence, Eigen::VectorXd beta, double delta,
+    /* simulation components */
+    std::size_t nsteps, std::size_t nthreads = 1, bool coordinates = false
+) {
+    TrajectorySimulator simulator(
+        *statespace, directional_persistence, beta, delta
+    );
+    auto simulate = [&](std::size_t start, StreamRandom & rng,
+                        std::uint32_t * path) {
+        simulator.simulate_steps(start, nsteps, rng, path);
+    };
+    return simulate_trajectories_impl(
+        simulator, state_ids, nsteps + 1, nthreads, coordinates,
+        simulate
+    );
+}
+
+/**
+ * Simulate many trajectories in continuous time via the Gillespie algorithm,
+ * i.e., the batch version of \code{Test__Particle_Gillespie_Steps}.
+ *
+ * Each trajectory uses its own random number stream, so results do not
+ * depend on the number of threads.
+ *
+ * @param statespace Object constructed from \code{build_statespace}
+ * @param state_ids 0-based ids of the state at times[1] for each trajectory
+ * @param times increasing times at which to record the trajectories
+ * @param nthreads number of threads to use
+ * @param coordinates TRUE to return coordinates rather than state ids
+ * @return list with a matrix of state ids, or matrices of eastings and
+ *   northings, with one row for each time and one column for each trajectory
+*/
+// [[Rcpp::export]]
+Rcpp::List simulate_trajectories_gillespie(
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::IntegerVector state_ids,
+    /* model parameters */
+    double directional_persistence, Eigen::VectorXd beta,
+    /* simulation components */
+    std::vector<double> times, std::size_t nthreads = 1,
+    bool coordinates = false
+) {
+    if(!std::is_sorted(times.begin(), times.end())) {
+        Rcpp::stop("Argument times must be in increasing order");
+    }
+    // the Gillespie algorithm uses the unscaled transition rates
+    TrajectorySimulator simulator(
+        *statespace, directional_persistence, beta, 1
+    );
+    auto simulate = [&](std::size_t start, StreamRandom & rng,
+                        std::uint32_t * path) {
+        simulator.simulate_times(start, times, rng, path);
+    };
+    return simulate_trajectories_impl(
+        simulator, state_ids, times.size(), nthreads, coordinates,
+        simulate
+    );
+}
+
+/**
+ * Simulate trajectories in discrete time via the uniformized transition 
+ * distribution, streaming each step to a trajectory file rather than 
+ * returning the trajectories, so memory use does not depend on the number of
+ * steps.  Trajectories are simulated one at a time and written sequentially,
+ * and match the trajectories \code{simulate_trajectories} returns for the 
+ * same random seed.
+ * 
+ * @param statespace Object constructed from \code{build_statespace}
+ * @param state_ids 0-based ids of the starting state for each trajectory
+ * @param nsteps number of steps to simulate
+ * @param path file to write, which can be read via 
+ *   \code{open_trajectory_file}.  Records' times are step numbers.
+ * @param chunk_size number of records to buffer between writes
+ * @return number of records written
+*/
+// [[Rcpp::export]]
+double simulate_trajectories_to_file(
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::IntegerVector state_ids,
+    /* model parameters */
+    double directional_persistence, Eigen::VectorXd beta, double delta,
+    /* simulation components */
+    std::size_t nsteps, std::string path, std::size_t chunk_size = 65536
+) {
+    TrajectorySimulator simulator(
+        *statespace, directional_persistence, beta, delta
+    );
+    for(auto id : state_ids) {
+        if(id < 0 || static_cast<std::size_t>(id) >= simulator.size()) {
+            Rcpp::stop("State ids must belong to the statespace");
+        }
+    }
+    std::vector<StreamRandom> streams = trajectory_streams(state_ids.size());
+    TrajectoryFileWriter writer(path, chunk_size);
+    for(std::size_t i = 0; i < streams.size(); ++i) {
+        writer.begin_path(i);
+        simulator.simulate_steps(state_ids[i], nsteps, streams[i], writer);
+    }
+    if(!writer.close()) {
+        Rcpp::stop("Unable to write file " + path);
+    }
+    return writer.size();
+}
+
+/**
+ * Simulate trajectories in continuous time via the Gillespie algorithm, 
+ * streaming the starting state and each transition to a trajectory file, so 
+ * memory use does not depend on the length of the trajectories.  
+ * Trajectories are simulated one at a time and written sequentially.
+ * 
+ * @param statespace Object constructed from \code{build_statespace}
+ * @param state_ids 0-based ids of the state at time 0 for each trajectory
+ * @param duration length of time to simulate
+ * @param path file to write, which can be read via 
+ *   \code{open_trajectory_file}.  Records' times are the times at which 
+ *   trajectories entered each state.
+ * @param chunk_size number of records to buffer between writes
+ * @return number of records written
+*/
+// [[Rcpp::export]]
+double simulate_trajectories_gillespie_to_file(
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::IntegerVector state_ids,
+    /* model parameters */
+    double directional_persistence, Eigen::VectorXd beta,
+    /* simulation components */
+    double duration, std::string path, std::size_t chunk_size = 65536
+) {
+    // the Gillespie algorithm uses the unscaled transition rates
+    TrajectorySimulator simulator(
+        *statespace, directional_persistence, beta, 1
+    );
+    for(auto id : state_ids) {
+        if(id < 0 || static_cast<std::size_t>(id) >= simulator.size()) {
+            Rcpp::stop("State ids must belong to the statespace");
+        }
+    }
+    std::vector<StreamRandom> streams = trajectory_streams(state_ids.size());
+    TrajectoryFileWriter writer(path, chunk_size);
+    for(std::size_t i = 0; i < streams.size(); ++i) {
+        writer.begin_path(i);
+        simulator.simulate_events(state_ids[i], 0, duration, streams[i], 
+            writer);
+    }
+    if(!writer.close()) {
+        Rcpp::stop("Unable to write file " + path);
+    }
+    return writer.size();
+}
@@ -0,0 +1,166 @@
+/**
+ * Tools to simulate many movement trajectories at once, i.e., for simulation
+ * studies with many replicate paths
+*/
+
+#ifndef MOVECON_SIMULATION_H
+#define MOVECON_SIMULATION_H
+
+// [[Rcpp::depends(RcppEigen)]]
+
+#include <RcppEigen.h>
+
+#include "Domain.h"
+#include "AppliedLikelihood.h"
+#include "ParticleGillespie.h"
+#include "Random.h"
+
+#include <cstdint>
+
+/**
+ * Forward-simulate trajectories on a statespace, either in discrete time via
+ * the uniformized transition distribution, or in continuous time via the
+ * Gillespie algorithm.  Trajectories are written as state ids, i.e.,
+ * State::index.
+ *
+ * The simulator primes the transition rates and probabilities cached in the
+ * statespace's states when it is built, after which simulation only reads the
+ * statespace, so trajectories may be simulated from several threads as long
+ * as each thread uses its own random number stream.  The statespace must not
+ * be used with other model parameters while the simulator is in use.
+*/
+class TrajectorySimulator {
+
+    public:
+
+        typedef RookDirectionalStatespace::StateType StateType;
+
+        typedef AppliedLikelihood::base_transition_rate base_transition_rate;
+        typedef AppliedLikelihood::uniformized_transition_rate
+            uniformized_transition_rate;
+        typedef AppliedLikelihood::particle_transition_rate
+            particle_transition_rate;
+        typedef AppliedLikelihood::directional_probabilities
+            directional_probabilities;
+        typedef AppliedLikelihood::particle_transition_probability
+            particle_transition_probability;
+
+        typedef Particle<
+            StateType,
+            particle_transition_rate,
+            particle_transition_probability,
+            StreamRandom
+        > StepParticleType;
+
+        typedef ParticleGillespie<
+            StateType,
+            base_transition_rate,
+            particle_transition_probability,
+            StreamRandom
+        > GillespieParticleType;
+
+    private:
+
+        // statespace's states, by state index
+        std::vector<StateType*> states;
+
+        // model, which the particles reference
+        Eigen::VectorXd beta;
+        base_transition_rate location_based_rate;
+        uniformized_transition_rate uniformized_rate;
+        particle_transition_rate transition_rate;
+        directional_probabilities directional_probs;
+        particle_transition_probability transition_prob;
+
+    public:
+
+        /**
+         * @param statespace statespace to simulate on
+         * @param directional_persistence,beta_init,delta model parameters
+        */
+        TrajectorySimulator(
+            RookDirectionalStatespace & statespace,
+            double directional_persistence,
+            const Eigen::Ref<const Eigen::VectorXd> & beta_init, double delta
+        );
+
+        TrajectorySimulator(const TrajectorySimulator &) = delete;
+        TrajectorySimulator & operator=(const TrajectorySimulator &) = delete;
+
+        /**
+         * Number of states in the statespace
+        */
+        std::size_t size() const { return states.size(); }
+
+        StateType * state(std::size_t id) const { return states[id]; }
+
+        /**
+         * Simulate nsteps discrete-time steps from a state, writing the
+         * nsteps + 1 state ids, including the starting state, to path
+        */
+        void simulate_steps(
+            std::size_t start, std::size_t nsteps, StreamRandom & rng,
+            std::uint32_t * path
+        );
+
+        /**
+         * Simulate nsteps discrete-time steps from a state, passing the time
+         * and state id after each step, starting with the initial state at 
+         * time 0, to a sink, i.e., to stream trajectories to a file
+         *
+         * @param sink function object with signature
+         *   void(double time, std::uint32_t state_id)
+        */
+        template<typename Sink>
+        void simulate_steps(
+            std::size_t start, std::size_t nsteps, StreamRandom & rng,
+            Sink & sink
+        ) {
+            StepParticleType particle(transition_rate, transition_prob, rng);
+            particle.state = states[start];
+            sink(0, start);
+            for(std::size_t i = 1; i <= nsteps; ++i) {
+                particle.step();
+                sink(i, particle.state->index);
+            }
+        }
+
+        /**
+         * Simulate in continuous time from a state at time t0 until time 
+         * tend, passing the starting state and the time and destination of 
+         * each transition to a sink
+         *
+         * @param sink function object with signature
+         *   void(double time, std::uint32_t state_id)
+        */
+        template<typename Sink>
+        void simulate_events(
+            std::size_t start, double t0, double tend, StreamRandom & rng,
+            Sink & sink
+        ) {
+            GillespieParticleType particle(
+                location_based_rate, transition_prob, rng
+            );
+            particle.state = states[start];
+            sink(t0, start);
+            auto observer = [&sink](double t, const StateType & destination) {
+                sink(t, destination.index);
+            };
+            particle.step(t0, tend, observer);
+        }
+
+        /**
+         * Simulate in continuous time from a state at times[0], writing the
+         * state ids at each of the times, including the starting state, to
+         * path
+         *
+         * @param times increasing observation times
+        */
+        void simulate_times(
+            std::size_t start, const std::vector<double> & times,
+            StreamRandom & rng, std::uint32_t * path
+        );
+
+};
+
+#endif
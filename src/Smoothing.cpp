@@ -0,0 +1,177 @@
+#include "Smoothing.h"
+
+#include "AppliedLikelihood.h"
+#include "Random.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+BackwardSimulationSmoother::BackwardSimulationSmoother(
+    RookDirectionalStatespace & statespace, const int * state_ids,
+    std::size_t M, std::size_t nt
+) : states(statespace.states.size()), nparticles(M) {
+
+    if(M == 0 || nt == 0) {
+        Rcpp::stop("Filtering distributions must not be empty");
+    }
+
+    for(auto & map_entry : statespace.states) {
+        states[map_entry.second.index] = &map_entry.second;
+    }
+
+    // count the particles in each state, for each filtering distribution
+    std::vector<std::uint32_t> sorted(M);
+    offsets.reserve(nt + 1);
+    offsets.push_back(0);
+    for(std::size_t t = 0; t < nt; ++t) {
+        const int * distribution = state_ids + t * M;
+        for(std::size_t i = 0; i < M; ++i) {
+            if(distribution[i] < 0 || 
+               static_cast<std::size_t>(distribution[i]) >= states.size()) {
+                Rcpp::stop("State ids must belong to the statespace");
+            }
+            sorted[i] = distribution[i];
+        }
+        std::sort(sorted.begin(), sorted.end());
+        for(std::size_t i = 0; i < M; ++i) {
+            if(i == 0 || sorted[i] != sorted[i - 1]) {
+                ids.push_back(sorted[i]);
+                counts.push_back(1);
+            } else {
+                ++counts.back();
+            }
+        }
+        offsets.push_back(ids.size());
+    }
+}
+
+double BackwardSimulationSmoother::count(
+    std::size_t t, std::uint32_t id
+) const {
+    auto begin = ids.begin() + offsets[t];
+    auto end = ids.begin() + offsets[t + 1];
+    auto it = std::lower_bound(begin, end, id);
+    return it != end && *it == id ? counts[it - ids.begin()] : 0;
+}
+
+double BackwardSimulationSmoother::transition_probability(
+    const StateType & from, const StateType * to
+) {
+    if(&from == to) {
+        return 1 - from.to_rate;
+    }
+    const double * mass = from.to_probabilities.data();
+    for(auto destination : from.to) {
+        if(destination == to) {
+            return from.to_rate * *mass;
+        }
+        ++mass;
+    }
+    return 0;
+}
+
+/**
+ * Sample latent paths from the smoothing distribution via forward-filtering 
+ * backward-simulation, given filtering distributions recorded as state ids at
+ * every discrete timepoint, i.e., by \code{Particle_Filter_State_Ids_From_GPS}
+ * with stride 1.  The model parameters must match the filter's parameters.
+ * 
+ * Each path uses its own random number stream, so results do not depend on 
+ * the number of threads.
+ * 
+ * @param statespace Object constructed from \code{build_statespace}, used to 
+ *   record state_ids
+ * @param state_ids matrix of state ids with one column for each discrete 
+ *   timepoint
+ * @param npaths number of paths to sample
+ * @param nthreads number of threads to use for sampling paths
+ * @return list with matrices of state ids, eastings, and northings, with one
+ *   column for each path.  Paths for which backward simulation failed, i.e., 
+ *   because the filtering distributions are not consistent with the model 
+ *   parameters, are NA.
+*/
+// [[Rcpp::export]]
+Rcpp::List sample_smoothed_paths(
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::IntegerMatrix state_ids,
+    /* model parameters */
+    double directional_persistence, Eigen::VectorXd beta, double delta,
+    /* sampling components */
+    std::size_t npaths, std::size_t nthreads = 1
+) {
+
+    typedef AppliedLikelihood::base_transition_rate base_transition_rate;
+    typedef AppliedLikelihood::uniformized_transition_rate 
+        uniformized_transition_rate;
+    typedef AppliedLikelihood::particle_transition_rate 
+        particle_transition_rate;
+    typedef AppliedLikelihood::directional_probabilities 
+        directional_probabilities;
+    typedef AppliedLikelihood::particle_transition_probability 
+        particle_transition_probability;
+
+    if(statespace->states.empty()) {
+        Rcpp::stop("Argument statespace must not be empty");
+    }
+    std::size_t npar = 
+        statespace->states.begin()->second.properties.location->x.size();
+    if(static_cast<std::size_t>(beta.size()) != npar) {
+        Rcpp::stop("Argument beta has the wrong length");
+    }
+
+    BackwardSimulationSmoother smoother(
+        *statespace, state_ids.begin(), state_ids.nrow(), state_ids.ncol()
+    );
+
+    // cache transition rates and probabilities for all states, so that paths 
+    // may be sampled in parallel
+    base_transition_rate location_based_rate(beta);
+    uniformized_transition_rate uniformized_rate(&location_based_rate, delta);
+    particle_transition_rate transition_rate(uniformized_rate);
+    directional_probabilities directional_probs(directional_persistence);
+    particle_transition_probability transition_prob(directional_probs);
+    statespace->reset_transition_cache();
+    statespace->prime_transition_cache(transition_rate, transition_prob);
+
+    // draw random number streams on the main thread
+    std::vector<StreamRandom> streams;
+    streams.reserve(npaths);
+    if(npaths > 0) {
+        streams.push_back(StreamRandom::from_r());
+    }
+    for(std::size_t i = 1; i < npaths; ++i) {
+        streams.push_back(streams.back().split());
+    }
+
+    // sample paths in parallel
+    std::size_t nt = smoother.size();
+    std::vector<std::uint32_t> paths(nt * npaths);
+    std::vector<char> sampled(npaths);
+    auto sample_path = [&](std::size_t i) {
+        sampled[i] = smoother.sample(streams[i], paths.data() + i * nt);
+    };
+    WorkStealingPool pool(nthreads);
+    pool.run(std::vector<double>(npaths, 1), sample_path);
+
+    // export paths
+    Rcpp::List locations = statespace_state_locations(statespace);
+    Rcpp::NumericVector state_eastings = locations["easting"];
+    Rcpp::NumericVector state_northings = locations["northing"];
+    Rcpp::IntegerMatrix path_ids(nt, npaths);
+    Rcpp::NumericMatrix path_eastings(nt, npaths);
+    Rcpp::NumericMatrix path_northings(nt, npaths);
+    for(std::size_t i = 0; i < npaths; ++i) {
+        for(std::size_t t = 0; t < nt; ++t) {
+            std::uint32_t id = paths[t + i * nt];
+            path_ids(t, i) = sampled[i] ? id : NA_INTEGER;
+            path_eastings(t, i) = sampled[i] ? state_eastings[id] : NA_REAL;
+            path_northings(t, i) = sampled[i] ? state_northings[id] : NA_REAL;
+        }
+    }
+
+    return Rcpp::List::create(
+        Rcpp::Named("state_ids") = path_ids,
+        Rcpp::Named("eastings") = path_eastings,
+        Rcpp::Named("northings") = path_northings
+    );
+}
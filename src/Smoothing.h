@@ -0,0 +1,160 @@
+/**
+ * Tools to sample latent paths from the smoothing distribution, given the
+ * filtering distributions from a particle filter
+*/
+
+#ifndef MOVECON_SMOOTHING_H
+#define MOVECON_SMOOTHING_H
+
+// [[Rcpp::depends(RcppEigen)]]
+
+#include <RcppEigen.h>
+
+#include "Domain.h"
+
+#include <cstdint>
+
+/**
+ * Forward-filtering backward-simulation smoother (Godsill et. al., 2004, doi:
+ * 10.1198/016214504000000151) for filtering distributions recorded as state
+ * ids at every discrete timepoint, i.e., by StateIdObserver.
+ *
+ * Particles within a filtering distribution have equal weight, so the
+ * backward kernel only depends on the number of particles in each state.
+ * Paths can only reach a state from the same state or from the states linked
+ * via the state's from set, so each backward step only visits those
+ * neighboring states rather than all particles.
+ *
+ * The backward kernel reads the transition rates and probabilities cached in
+ * the statespace's states, so the cache must be primed for the model
+ * parameters before sampling, i.e., via prime_transition_cache().  Sampling
+ * does not modify the smoother or statespace, so paths may be sampled from
+ * several threads.
+*/
+class BackwardSimulationSmoother {
+
+    public:
+
+        typedef RookDirectionalStatespace::StateType StateType;
+
+    private:
+
+        // statespace's states, by state index
+        std::vector<StateType*> states;
+
+        // distinct state ids within each filtering distribution, sorted by
+        // id, with the number of particles in each state, in compressed
+        // sparse column format
+        std::vector<std::size_t> offsets;
+        std::vector<std::uint32_t> ids;
+        std::vector<double> counts;
+
+        // number of particles in each filtering distribution
+        std::size_t nparticles;
+
+        /**
+         * Number of particles in a state at timepoint t
+        */
+        double count(std::size_t t, std::uint32_t id) const;
+
+        /**
+         * Probability of a single-step transition between two states
+        */
+        static double transition_probability(
+            const StateType & from, const StateType * to
+        );
+
+    public:
+
+        /**
+         * @param statespace statespace for the filtering distributions
+         * @param state_ids state ids for M particles at each of nt
+         *   timepoints, stored contiguously by timepoint
+        */
+        BackwardSimulationSmoother(
+            RookDirectionalStatespace & statespace, const int * state_ids,
+            std::size_t M, std::size_t nt
+        );
+
+        /**
+         * Number of timepoints in each path
+        */
+        std::size_t size() const { return offsets.size() - 1; }
+
+        /**
+         * Sample a path from the smoothing distribution, writing state ids
+         * for each timepoint to path.  Returns false if the backward kernel
+         * has no mass, i.e., if the filtering distributions are not
+         * consistent with single-step transitions.
+        */
+        template<typename RandomSource>
+        bool sample(RandomSource & rng, std::uint32_t * path) const {
+
+            std::size_t nt = size();
+
+            // final state from the final filtering distribution
+            double p = rng.runif() * nparticles;
+            double cumulative_count = 0;
+            std::size_t i = offsets[nt - 1];
+            std::size_t end = offsets[nt];
+            for(; i < end - 1; ++i) {
+                cumulative_count += counts[i];
+                if(cumulative_count > p) {
+                    break;
+                }
+            }
+            path[nt - 1] = ids[i];
+
+            // scratch space for the backward kernel's support and mass
+            const std::size_t max_support = 8;
+            StateType * support[max_support];
+            double mass[max_support];
+
+            for(std::size_t t = nt - 1; t > 0; --t) {
+
+                const StateType * next = states[path[t]];
+
+                // mass for self-transition and transitions from neighbors,
+                // omitting states that have no mass
+                std::size_t n = 0;
+                double total_mass = 0;
+                auto add_source = [&](StateType * source) {
+                    double m = count(t - 1, source->index) *
+                        transition_probability(*source, next);
+                    if(m > 0) {
+                        support[n] = source;
+                        mass[n++] = m;
+                        total_mass += m;
+                    }
+                };
+                add_source(states[path[t]]);
+                for(auto source : next->from) {
+                    if(n == max_support) {
+                        break;
+                    }
+                    add_source(source);
+                }
+
+                if(!(total_mass > 0)) {
+                    return false;
+                }
+
+                // sample the previous state from the backward kernel
+                p = rng.runif() * total_mass;
+                cumulative_count = 0;
+                std::size_t j = 0;
+                for(; j < n - 1; ++j) {
+                    cumulative_count += mass[j];
+                    if(cumulative_count > p) {
+                        break;
+                    }
+                }
+                path[t - 1] = support[j]->index;
+            }
+
+            return true;
+        }
+
+};
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * Orderings of spatial locations along space-filling curves
+*/
+
+#ifndef MOVECON_SPACE_FILLING_CURVE_H
+#define MOVECON_SPACE_FILLING_CURVE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+/**
+ * Position of a cell along a Hilbert curve that fills a 2^order x 2^order grid
+ *
+ * @param x column index of the cell, in [0, 2^order)
+ * @param y row index of the cell, in [0, 2^order)
+ * @param order number of bits used for each coordinate, at most 32
+*/
+inline std::uint64_t hilbert_index(
+    std::uint32_t x, std::uint32_t y, unsigned order = 16
+) {
+    std::uint64_t d = 0;
+    for(std::uint64_t s = std::uint64_t(1) << (order - 1); s > 0; s >>= 1) {
+        std::uint32_t rx = (x & s) > 0;
+        std::uint32_t ry = (y & s) > 0;
+        d += s * s * ((3 * rx) ^ ry);
+        // rotate the quadrant so the curve is continuous
+        if(ry == 0) {
+            if(rx == 1) {
+                x = static_cast<std::uint32_t>(s - 1) - x;
+                y = static_cast<std::uint32_t>(s - 1) - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+/**
+ * Order particles along a Hilbert curve through the bounding box of their
+ * locations.  Particles at the same location keep their relative order.
+ *
+ * @param particles particles whose states have a location with easting and
+ *   northing coordinates
+ * @param order output for particle indices, in curve order
+ * @param keys scratch space for curve positions
+*/
+template<typename Particle>
+void hilbert_sort(
+    const std::vector<Particle> & particles, std::vector<std::size_t> & order,
+    std::vector<std::uint64_t> & keys
+) {
+
+    std::size_t n = particles.size();
+    order.resize(n);
+    keys.resize(n);
+    std::iota(order.begin(), order.end(), 0);
+    if(n == 0) {
+        return;
+    }
+
+    // bounding box for the particle cloud
+    double min_easting = particles[0].state->properties.location->easting;
+    double max_easting = min_easting;
+    double min_northing = particles[0].state->properties.location->northing;
+    double max_northing = min_northing;
+    for(auto & particle : particles) {
+        auto location = particle.state->properties.location;
+        min_easting = std::min(min_easting, location->easting);
+        max_easting = std::max(max_easting, location->easting);
+        min_northing = std::min(min_northing, location->northing);
+        max_northing = std::max(max_northing, location->northing);
+    }
+
+    // map coordinates to a 2^16 x 2^16 grid over the bounding box
+    const double ncells = 65535;
+    double easting_scale = max_easting > min_easting ?
+        ncells / (max_easting - min_easting) : 0;
+    double northing_scale = max_northing > min_northing ?
+        ncells / (max_northing - min_northing) : 0;
+    for(std::size_t i = 0; i < n; ++i) {
+        auto location = particles[i].state->properties.location;
+        keys[i] = hilbert_index(
+            static_cast<std::uint32_t>(
+                (location->easting - min_easting) * easting_scale
+            ),
+            static_cast<std::uint32_t>(
+                (location->northing - min_northing) * northing_scale
+            )
+        );
+    }
+
+    std::stable_sort(
+        order.begin(), order.end(),
+        [&keys](std::size_t a, std::size_t b) { return keys[a] < keys[b]; }
+    );
+}
+
+#endif
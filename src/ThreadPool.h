@@ -0,0 +1,147 @@
+/**
+ * Scheduling utilities for running independent tasks on several threads
+*/
+
+#ifndef MOVECON_THREAD_POOL_H
+#define MOVECON_THREAD_POOL_H
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+/**
+ * Run a fixed collection of independent tasks on a set of threads using work
+ * stealing.
+ *
+ * Tasks are identified by their index and are dealt round-robin to per-thread
+ * queues in order of decreasing cost, so that each thread starts with a
+ * similar workload.  Threads take work from the front of their own queue, and
+ * take work from the back of other threads' queues once their own queue is
+ * empty, which balances the load when task costs are only approximately
+ * known (i.e., for filtering tracks with different lengths).
+ *
+ * Tasks must not call the R API.  The first exception thrown by a task is
+ * rethrown on the calling thread after all threads finish.
+*/
+class WorkStealingPool {
+
+    private:
+
+        struct TaskQueue {
+            std::deque<std::size_t> tasks;
+            std::mutex lock;
+        };
+
+        std::size_t m_nthreads;
+
+        std::vector<TaskQueue> queues;
+
+        bool pop_front(std::size_t thread, std::size_t & task) {
+            TaskQueue & queue = queues[thread];
+            std::lock_guard<std::mutex> guard(queue.lock);
+            if(queue.tasks.empty()) {
+                return false;
+            }
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+            return true;
+        }
+
+        bool steal(std::size_t thread, std::size_t & task) {
+            for(std::size_t i = 1; i < m_nthreads; ++i) {
+                TaskQueue & queue = queues[(thread + i) % m_nthreads];
+                std::lock_guard<std::mutex> guard(queue.lock);
+                if(!queue.tasks.empty()) {
+                    task = queue.tasks.back();
+                    queue.tasks.pop_back();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    public:
+
+        /**
+         * @param nthreads number of threads to use, including the calling
+         *   thread.  Uses 1 thread if 0 is requested.
+        */
+        WorkStealingPool(std::size_t nthreads) :
+            m_nthreads(std::max<std::size_t>(nthreads, 1)),
+            queues(m_nthreads) { }
+
+        std::size_t nthreads() const { return m_nthreads; }
+
+        /**
+         * Run task(i) for each i in 0, ..., costs.size() - 1
+         *
+         * @param costs relative cost of each task, used for initial scheduling
+         * @param task function object that runs a task given its index
+        */
+        template<typename Task>
+        void run(const std::vector<double> & costs, Task & task) {
+
+            std::size_t ntasks = costs.size();
+
+            // run tasks in the calling thread if no concurrency is possible
+            if(m_nthreads == 1 || ntasks < 2) {
+                for(std::size_t i = 0; i < ntasks; ++i) {
+                    task(i);
+                }
+                return;
+            }
+
+            // deal tasks to threads in order of decreasing cost
+            std::vector<std::size_t> order(ntasks);
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(
+                order.begin(), order.end(),
+                [&costs](std::size_t a, std::size_t b) {
+                    return costs[a] > costs[b];
+                }
+            );
+            for(std::size_t i = 0; i < ntasks; ++i) {
+                queues[i % m_nthreads].tasks.push_back(order[i]);
+            }
+
+            std::exception_ptr error;
+            std::mutex error_lock;
+
+            auto worker = [&](std::size_t thread) {
+                std::size_t ind;
+                while(pop_front(thread, ind) || steal(thread, ind)) {
+                    try {
+                        task(ind);
+                    } catch(...) {
+                        std::lock_guard<std::mutex> guard(error_lock);
+                        if(!error) {
+                            error = std::current_exception();
+                        }
+                    }
+                }
+            };
+
+            // the calling thread also works through tasks
+            std::size_t nworkers = std::min(m_nthreads, ntasks);
+            std::vector<std::thread> threads;
+            threads.reserve(nworkers - 1);
+            for(std::size_t thread = 1; thread < nworkers; ++thread) {
+                threads.emplace_back(worker, thread);
+            }
+            worker(0);
+            for(auto & thread : threads) {
+                thread.join();
+            }
+
+            if(error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+};
+
+#endif
@@ -0,0 +1,215 @@
+#include "ParticleFilter.h"
+
+#include "Particle.h"
+#include "Domain.h"
+#include "Tx.h"
+#include "AppliedLikelihood.h"
+#include "Random.h"
+#include "ThreadPool.h"
+
+#include <RcppEigen.h>
+
+// [[Rcpp::depends(RcppEigen)]]
+
+namespace {
+
+    typedef RookDirectionalStatespace::StateType StateType;
+
+    typedef AppliedLikelihood::base_transition_rate base_transition_rate;
+    typedef AppliedLikelihood::uniformized_transition_rate
+        uniformized_transition_rate;
+    typedef AppliedLikelihood::particle_transition_rate
+        particle_transition_rate;
+    typedef AppliedLikelihood::directional_probabilities
+        directional_probabilities;
+    typedef AppliedLikelihood::particle_transition_probability
+        particle_transition_probability;
+
+    // particles draw from per-track random number streams
+    typedef Particle<
+        StateType,
+        particle_transition_rate,
+        particle_transition_probability,
+        StreamRandom
+    > ParticleType;
+
+    typedef std::vector<std::unique_ptr<AppliedLikelihood>> LikelihoodSeqType;
+    typedef std::vector<NStepProposal<ParticleType>> ProposalSeqType;
+
+    typedef BootstrapParticleFilter<
+        ParticleType,
+        ProposalSeqType,
+        LikelihoodSeqType,
+        NullObserver<ParticleType>,
+        StreamRandom
+    > FilterType;
+
+    /**
+     * Particle filter and supporting objects for a single track.  Particles
+     * and the filter hold pointers to the track's random number stream, so
+     * TrackFilter objects must not be moved after construction.
+    */
+    struct TrackFilter {
+
+        LikelihoodSeqType likelihood_seq;
+        ProposalSeqType proposal_seq;
+        StreamRandom random_source;
+        std::vector<ParticleType> particles;
+        std::unique_ptr<FilterType> filter;
+
+        TrackFilter(
+            LikelihoodSeqType && likelihoods, const StreamRandom & stream
+        ) : likelihood_seq(std::move(likelihoods)),
+            proposal_seq(
+                ConstantStepFamily<ParticleType>(likelihood_seq.size(), 1)
+            ),
+            random_source(stream) { }
+
+        TrackFilter(const TrackFilter &) = delete;
+        TrackFilter & operator=(const TrackFilter &) = delete;
+
+    };
+
+}
+
+/**
+ * Particle filter approximations to the marginal log-likelihoods of many
+ * tracks (i.e., for different animals) that move on the same statespace and
+ * share the same model parameters.
+ *
+ * Filters for the tracks run concurrently, with tracks scheduled across
+ * threads via work stealing.  Transition rates and probabilities are cached
+ * for all states before the filters run, so the statespace is only read while
+ * filtering.  Each track draws random numbers from its own stream, seeded
+ * from R's random number generator, so results are reproducible via
+ * set.seed() and do not depend on the number of threads.
+ *
+ * @param tracks list with one entry for each track.  Each entry is a list
+ *   with the track's GPS observations (eastings, northings, hdops), the
+ *   discrete time indices t (starting at 0) at which observations are
+ *   available, and the total number of discrete timepoints nt
+ * @param uere user equivalent range error for all GPS observations
+ * @param statespace Object constructed from \code{build_statespace}
+ * @param initial_latent_state_samples list with one sample of states for
+ *   each track, i.e., from \code{sample_gaussian_states_from_hdop_uere}
+ * @param nthreads number of threads to use
+*/
+// [[Rcpp::export]]
+Rcpp::List Batch_Particle_Filter_Likelihood_From_GPS(
+    /* likelihood components */
+    Rcpp::List tracks, double uere,
+    /* filter components */
+    Rcpp::XPtr<RookDirectionalStatespace> statespace,
+    Rcpp::List initial_latent_state_samples,
+    /* model parameters */
+    double directional_persistence, Eigen::VectorXd beta, double delta,
+    /* computational settings */
+    std::size_t nthreads
+) {
+
+    std::size_t ntracks = tracks.size();
+    if(initial_latent_state_samples.size() != ntracks) {
+        Rcpp::stop(
+            "Arguments tracks and initial_latent_state_samples must have the "
+            "same length"
+        );
+    }
+
+    //
+    // build transition evaluators and prime state caches
+    //
+
+    // reset cached state values
+    statespace->reset_transition_cache();
+
+    // construct transition rate evaluator
+    base_transition_rate location_based_rate(beta);
+    uniformized_transition_rate uniformized_rate(&location_based_rate, delta);
+    particle_transition_rate transition_rate(uniformized_rate);
+
+    // construct transition probability evaluator
+    directional_probabilities directional_probs(directional_persistence);
+    particle_transition_probability transition_prob(directional_probs);
+
+    // evaluate all cached values before filters run concurrently
+    statespace->prime_transition_cache(transition_rate, transition_prob);
+
+    //
+    // build filters, interacting with R only from the main thread
+    //
+
+    std::vector<std::unique_ptr<TrackFilter>> track_filters;
+    track_filters.reserve(ntracks);
+    std::vector<double> costs;
+    costs.reserve(ntracks);
+
+    StreamRandom stream = StreamRandom::from_r();
+    for(std::size_t i = 0; i < ntracks; ++i) {
+
+        Rcpp::List track = tracks[i];
+        std::vector<double> eastings = track["eastings"];
+        std::vector<double> northings = track["northings"];
+        std::vector<double> hdops = track["hdops"];
+        std::vector<std::size_t> t = track["t"];
+        std::size_t nt = track["nt"];
+
+        Rcpp::XPtr<std::vector<StateType*>> initial_latent_state_sample =
+            initial_latent_state_samples[i];
+        if(initial_latent_state_sample->empty()) {
+            Rcpp::stop("Initial latent state samples must not be empty");
+        }
+
+        track_filters.emplace_back(
+            new TrackFilter(
+                AppliedLikelihoodFamilyFromGPS(
+                    eastings, northings, hdops, uere, t, nt
+                ),
+                stream
+            )
+        );
+        stream = stream.split();
+
+        // build particles for the initial states
+        TrackFilter & tf = *track_filters.back();
+        tf.particles.reserve(initial_latent_state_sample->size());
+        ParticleType particle(
+            transition_rate, transition_prob, tf.random_source
+        );
+        for(auto state : *initial_latent_state_sample) {
+            particle.state = state;
+            tf.particles.push_back(particle);
+        }
+
+        tf.filter.reset(new FilterType(tf.particles));
+        tf.filter->proposal_distributions = &tf.proposal_seq;
+        tf.filter->likelihoods = &tf.likelihood_seq;
+        tf.filter->random_source = &tf.random_source;
+
+        // filtering cost scales with the number of particle steps
+        costs.push_back(
+            static_cast<double>(nt) * initial_latent_state_sample->size()
+        );
+    }
+
+    //
+    // run filters
+    //
+
+    std::vector<double> ll(ntracks);
+    auto run_filter = [&](std::size_t i) {
+        ll[i] = track_filters[i]->filter->marginal_ll();
+    };
+    WorkStealingPool pool(nthreads);
+    pool.run(costs, run_filter);
+
+    double total = 0;
+    for(auto x : ll) {
+        total += x;
+    }
+
+    // package results
+    return Rcpp::List::create(
+        Rcpp::Named("ll") = ll,
+        Rcpp::Named("total") = total
+    );
+}
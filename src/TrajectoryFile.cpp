@@ -0,0 +1,187 @@
+#include "TrajectoryFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+TrajectoryFileWriter::TrajectoryFileWriter(
+    const std::string & path, std::size_t chunk
+) : out(path, std::ios::binary | std::ios::trunc),
+    chunk_size(std::max<std::size_t>(chunk, 1)), current_path(0),
+    nrecords(0) {
+
+    if(!out) {
+        Rcpp::stop("Unable to open file " + path);
+    }
+
+    buffer.reserve(chunk_size);
+
+    std::uint64_t record_size = sizeof(TrajectoryRecord);
+    out.write(trajectory_file::magic, sizeof(trajectory_file::magic));
+    out.write(
+        reinterpret_cast<const char *>(&record_size), sizeof(record_size)
+    );
+}
+
+void TrajectoryFileWriter::flush() {
+    if(buffer.empty()) {
+        return;
+    }
+    out.write(
+        reinterpret_cast<const char *>(buffer.data()),
+        buffer.size() * sizeof(TrajectoryRecord)
+    );
+    nrecords += buffer.size();
+    buffer.clear();
+}
+
+bool TrajectoryFileWriter::close() {
+    if(!out.is_open()) {
+        return !out.fail();
+    }
+    flush();
+    out.close();
+    return !out.fail();
+}
+
+TrajectoryFileReader::TrajectoryFileReader(const std::string & path) :
+    records(nullptr), nrecords(0) {
+
+    try {
+        file = boost::interprocess::file_mapping(
+            path.c_str(), boost::interprocess::read_only
+        );
+        region = boost::interprocess::mapped_region(
+            file, boost::interprocess::read_only
+        );
+    } catch(const boost::interprocess::interprocess_exception & e) {
+        Rcpp::stop("Unable to map file " + path + ": " + e.what());
+    }
+
+    // validate header
+    const char * data = static_cast<const char *>(region.get_address());
+    std::size_t bytes = region.get_size();
+    std::uint64_t record_size = 0;
+    if(bytes >= trajectory_file::header_size) {
+        std::memcpy(
+            &record_size, data + sizeof(trajectory_file::magic),
+            sizeof(record_size)
+        );
+    }
+    if(bytes < trajectory_file::header_size ||
+       std::memcmp(data, trajectory_file::magic,
+                   sizeof(trajectory_file::magic)) != 0 ||
+       record_size != sizeof(TrajectoryRecord)) {
+        Rcpp::stop("File " + path + " is not a trajectory file");
+    }
+    if((bytes - trajectory_file::header_size) % sizeof(TrajectoryRecord)) {
+        Rcpp::stop("File " + path + " ends with an incomplete record");
+    }
+
+    records = reinterpret_cast<const TrajectoryRecord *>(
+        data + trajectory_file::header_size
+    );
+    nrecords = (bytes - trajectory_file::header_size) /
+        sizeof(TrajectoryRecord);
+}
+
+std::pair<const TrajectoryRecord *, const TrajectoryRecord *>
+TrajectoryFileReader::path_records(std::uint32_t path) const {
+    auto first = std::lower_bound(
+        begin(), end(), path,
+        [](const TrajectoryRecord & record, std::uint32_t p) {
+            return record.path < p;
+        }
+    );
+    auto last = std::upper_bound(
+        first, end(), path,
+        [](std::uint32_t p, const TrajectoryRecord & record) {
+            return p < record.path;
+        }
+    );
+    return std::make_pair(first, last);
+}
+
+/**
+ * Open a trajectory file written by, e.g.,
+ * \code{simulate_trajectories_to_file}.  The file is memory-mapped, so
+ * trajectories are only read from disk as they are accessed.
+ *
+ * @param path file to read
+*/
+// [[Rcpp::export]]
+Rcpp::XPtr<TrajectoryFileReader> open_trajectory_file(std::string path) {
+    return Rcpp::XPtr<TrajectoryFileReader>(
+        new TrajectoryFileReader(path), true
+    );
+}
+
+/**
+ * Number of records and trajectories in a trajectory file
+ *
+ * @param reader Object constructed from \code{open_trajectory_file}
+*/
+// [[Rcpp::export]]
+Rcpp::List trajectory_file_summary(Rcpp::XPtr<TrajectoryFileReader> reader) {
+    return Rcpp::List::create(
+        Rcpp::Named("nrecords") = static_cast<double>(reader->size()),
+        Rcpp::Named("npaths") = static_cast<double>(reader->npaths())
+    );
+}
+
+/**
+ * Read one trajectory from a trajectory file
+ *
+ * @param reader Object constructed from \code{open_trajectory_file}
+ * @param path 0-based id of the trajectory to read
+ * @return list with the times at which the trajectory entered each state,
+ *   and the 0-based state ids
+*/
+// [[Rcpp::export]]
+Rcpp::List read_trajectory(
+    Rcpp::XPtr<TrajectoryFileReader> reader, std::size_t path
+) {
+    auto range = reader->path_records(path);
+    std::size_t n = range.second - range.first;
+    Rcpp::NumericVector times(n);
+    Rcpp::IntegerVector state_ids(n);
+    std::size_t i = 0;
+    for(auto record = range.first; record != range.second; ++record) {
+        times[i] = record->time;
+        state_ids[i++] = record->state;
+    }
+    return Rcpp::List::create(
+        Rcpp::Named("time") = times,
+        Rcpp::Named("state_id") = state_ids
+    );
+}
+
+/**
+ * Read a block of consecutive records from a trajectory file, i.e., to scan
+ * a file in chunks
+ *
+ * @param reader Object constructed from \code{open_trajectory_file}
+ * @param first 0-based index of the first record to read
+ * @param n maximum number of records to read
+ * @return list with the 0-based path ids, times, and 0-based state ids for
+ *   each record
+*/
+// [[Rcpp::export]]
+Rcpp::List read_trajectory_records(
+    Rcpp::XPtr<TrajectoryFileReader> reader, std::size_t first, std::size_t n
+) {
+    first = std::min(first, reader->size());
+    n = std::min(n, reader->size() - first);
+    Rcpp::IntegerVector paths(n), state_ids(n);
+    Rcpp::NumericVector times(n);
+    for(std::size_t i = 0; i < n; ++i) {
+        const TrajectoryRecord & record = (*reader)[first + i];
+        paths[i] = record.path;
+        times[i] = record.time;
+        state_ids[i] = record.state;
+    }
+    return Rcpp::List::create(
+        Rcpp::Named("path") = paths,
+        Rcpp::Named("time") = times,
+        Rcpp::Named("state_id") = state_ids
+    );
+}
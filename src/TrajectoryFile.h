@@ -0,0 +1,155 @@
+/**
+ * Binary files for simulated trajectories that are too long to hold in memory
+*/
+
+#ifndef MOVECON_TRAJECTORY_FILE_H
+#define MOVECON_TRAJECTORY_FILE_H
+
+#include <Rcpp.h>
+
+// [[Rcpp::depends(BH)]]
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * Fixed-width record for a trajectory file, which gives the state a
+ * trajectory occupies from a time onward
+*/
+struct TrajectoryRecord {
+    double time;
+    std::uint32_t path;
+    std::uint32_t state;
+};
+
+static_assert(
+    sizeof(TrajectoryRecord) == 16, "TrajectoryRecord must be 16 bytes"
+);
+
+/**
+ * Trajectory files begin with an 8-byte format identifier and the record
+ * size as a 64-bit unsigned integer, followed by the records.  Records for
+ * each trajectory are contiguous and in time order, and trajectories are
+ * stored in order of their path ids.  Values use the machine's native byte
+ * order.
+*/
+namespace trajectory_file {
+    const char magic[8] = { 'M', 'V', 'T', 'R', 'A', 'J', '0', '1' };
+    const std::size_t header_size = 16;
+}
+
+/**
+ * Sink for TrajectorySimulator that streams records to a trajectory file in
+ * chunks, so memory use does not depend on the length of the trajectories.
+ * Trajectories must be written one at a time, in order of their path ids.
+*/
+class TrajectoryFileWriter {
+
+    private:
+
+        std::ofstream out;
+
+        // records waiting to be written
+        std::vector<TrajectoryRecord> buffer;
+        std::size_t chunk_size;
+
+        std::uint32_t current_path;
+
+        std::uint64_t nrecords;
+
+    public:
+
+        /**
+         * @param path file to write, which is replaced if it exists
+         * @param chunk number of records to buffer between writes
+        */
+        TrajectoryFileWriter(const std::string & path, std::size_t chunk);
+
+        TrajectoryFileWriter(const TrajectoryFileWriter &) = delete;
+        TrajectoryFileWriter & operator=(const TrajectoryFileWriter &) =
+            delete;
+
+        ~TrajectoryFileWriter() { close(); }
+
+        /**
+         * Write subsequent records for a new trajectory
+        */
+        void begin_path(std::uint32_t path) { current_path = path; }
+
+        void operator()(double time, std::uint32_t state_id) {
+            buffer.push_back(TrajectoryRecord{time, current_path, state_id});
+            if(buffer.size() >= chunk_size) {
+                flush();
+            }
+        }
+
+        /**
+         * Write buffered records
+        */
+        void flush();
+
+        /**
+         * Write buffered records and close the file, returning false if any
+         * write failed
+        */
+        bool close();
+
+        bool good() const { return out.good(); }
+
+        std::uint64_t size() const { return nrecords; }
+
+};
+
+/**
+ * Read a trajectory file via a read-only memory map, so records are read
+ * directly from the operating system's page cache without copying the file
+ * into memory
+*/
+class TrajectoryFileReader {
+
+    private:
+
+        boost::interprocess::file_mapping file;
+        boost::interprocess::mapped_region region;
+
+        const TrajectoryRecord * records;
+        std::size_t nrecords;
+
+    public:
+
+        explicit TrajectoryFileReader(const std::string & path);
+
+        TrajectoryFileReader(const TrajectoryFileReader &) = delete;
+        TrajectoryFileReader & operator=(const TrajectoryFileReader &) =
+            delete;
+
+        std::size_t size() const { return nrecords; }
+
+        const TrajectoryRecord * begin() const { return records; }
+        const TrajectoryRecord * end() const { return records + nrecords; }
+
+        const TrajectoryRecord & operator[](std::size_t i) const {
+            return records[i];
+        }
+
+        /**
+         * Number of trajectories, assuming path ids start at 0
+        */
+        std::size_t npaths() const {
+            return nrecords > 0 ? records[nrecords - 1].path + 1 : 0;
+        }
+
+        /**
+         * First record for a trajectory, and the record after its last
+        */
+        std::pair<const TrajectoryRecord *, const TrajectoryRecord *>
+        path_records(std::uint32_t path) const;
+
+};
+
+#endif
@@ -0,0 +1,309 @@
+/**
+ * Precomputed transition rates and probabilities for batches of model
+ * parameters
+*/
+
+#ifndef MOVECON_TRANSITION_TABLE_H
+#define MOVECON_TRANSITION_TABLE_H
+
+#include <RcppEigen.h>
+
+// [[Rcpp::depends(RcppEigen)]]
+
+#include <cstdint>
+
+/**
+ * Compute the start of each state's transition probabilities within a table
+ * that stores the transition probabilities for all states contiguously, in
+ * order of State::index and the states' "to" links.  The final entry gives
+ * the total number of links in the statespace.
+*/
+template<typename Statespace>
+std::vector<std::size_t> transition_offsets(const Statespace & statespace) {
+    std::size_t nstates = statespace.states.size();
+    std::vector<std::size_t> offsets(nstates + 1, 0);
+    for(auto & entry : statespace.states) {
+        offsets[entry.second.index + 1] = entry.second.to.size();
+    }
+    for(std::size_t i = 0; i < nstates; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+    return offsets;
+}
+
+/**
+ * Uniformized transition rates and transition probabilities for every state in
+ * a statespace, evaluated for K sets of model parameters.
+ *
+ * All parameter sets share the same memory layout.  Rates are indexed by
+ * State::index.  Transition probabilities for all states are stored
+ * contiguously, with the probabilities for a state starting at
+ * offsets[State::index] and following the order of the state's "to" links.
+*/
+struct TransitionTableBatch {
+
+    // start of each state's transition probabilities, with a final entry
+    // that gives the total number of links in the statespace
+    std::vector<std::size_t> offsets;
+
+    // rates[k][i] is the uniformized transition rate away from state i for
+    // parameter set k
+    std::vector<std::vector<double>> rates;
+
+    // probabilities[k][offsets[i] + j] is the probability that the j'th "to"
+    // link is used when transitioning away from state i for parameter set k
+    std::vector<std::vector<double>> probabilities;
+
+    std::size_t size() const { return rates.size(); }
+
+    /**
+     * Evaluate Hewitt et. al. (2023) eq. 14 and 15 for all states and
+     * parameter sets in a single pass through the statespace
+     *
+     * @param statespace statespace with indexed states
+     * @param directional_persistence directional persistence for each of the
+     *   K parameter sets
+     * @param beta matrix whose K columns are the location-based movement
+     *   parameters for each parameter set
+     * @param delta uniformization constant applied to all rates
+    */
+    template<typename Statespace, typename DirectionalPersistence>
+    static TransitionTableBatch build(
+        Statespace & statespace,
+        const std::vector<double> & directional_persistence,
+        const Eigen::MatrixXd & beta, double delta
+    ) {
+        TransitionTableBatch res;
+        res.evaluate<Statespace, DirectionalPersistence>(
+            statespace, directional_persistence, beta, delta
+        );
+        return res;
+    }
+
+    /**
+     * Re-evaluate the table for new parameter sets.  Storage is reused if
+     * the number of parameter sets does not change, so evaluators built for
+     * the table remain valid.
+    */
+    template<typename Statespace, typename DirectionalPersistence>
+    void evaluate(
+        Statespace & statespace,
+        const std::vector<double> & directional_persistence,
+        const Eigen::MatrixXd & beta, double delta
+    ) {
+
+        std::size_t K = directional_persistence.size();
+        std::size_t nstates = statespace.states.size();
+
+        // layout for transition probabilities
+        if(offsets.size() != nstates + 1) {
+            offsets = transition_offsets(statespace);
+        }
+        std::size_t nlinks = offsets[nstates];
+
+        rates.resize(K);
+        probabilities.resize(K);
+        for(std::size_t k = 0; k < K; ++k) {
+            rates[k].resize(nstates);
+            probabilities[k].resize(nlinks);
+        }
+
+        Eigen::VectorXd eta(K);
+        std::vector<double> covariates;
+
+        for(auto & entry : statespace.states) {
+
+            auto & state = entry.second;
+            std::size_t i = state.index;
+
+            // location-based rates for all parameter sets
+            eta.noalias() = beta.transpose() * state.properties.location->x;
+            for(std::size_t k = 0; k < K; ++k) {
+                rates[k][i] = delta * std::exp(eta(k));
+            }
+
+            // directional persistence covariates are shared by all sets
+            covariates.clear();
+            for(auto destination : state.to) {
+                covariates.push_back(
+                    DirectionalPersistence::directional_persistence_covariate(
+                        state.properties.last_movement_direction,
+                        destination->properties.last_movement_direction
+                    )
+                );
+            }
+
+            // standardized transition distributions for all parameter sets
+            for(std::size_t k = 0; k < K; ++k) {
+                double * p = probabilities[k].data() + offsets[i];
+                double total = 0;
+                for(std::size_t j = 0; j < covariates.size(); ++j) {
+                    p[j] = std::exp(directional_persistence[k] * covariates[j]);
+                    total += p[j];
+                }
+                for(std::size_t j = 0; j < covariates.size(); ++j) {
+                    p[j] /= total;
+                }
+            }
+        }
+    }
+
+};
+
+/**
+ * Read transition rates for one parameter set from a TransitionTableBatch
+*/
+template<typename State>
+class table_rate_evaluator {
+
+    private:
+
+        const double * m_rates;
+
+    public:
+
+        table_rate_evaluator(
+            const TransitionTableBatch & table, std::size_t k
+        ) : m_rates(table.rates[k].data()) { }
+
+        double transition_rate(const State & state) const {
+            return m_rates[state.index];
+        }
+};
+
+/**
+ * Read transition probabilities for one parameter set from a
+ * TransitionTableBatch
+*/
+template<typename State>
+class table_transition_probability_evaluator {
+
+    private:
+
+        const double * m_probabilities;
+        const std::size_t * m_offsets;
+
+    public:
+
+        table_transition_probability_evaluator(
+            const TransitionTableBatch & table, std::size_t k
+        ) : m_probabilities(table.probabilities[k].data()),
+            m_offsets(table.offsets.data()) { }
+
+        Eigen::Map<const Eigen::VectorXd> probabilities(
+            const State & state
+        ) const {
+            return Eigen::Map<const Eigen::VectorXd>(
+                m_probabilities + m_offsets[state.index], state.to.size()
+            );
+        }
+};
+
+/**
+ * Uniformized transition rates and transition probabilities for a single
+ * parameter set, evaluated on demand and stored in tables owned by the
+ * LazyTransitionTable rather than in the shared statespace.
+ *
+ * Objects can serve as both the transition_rate_evaluator and the
+ * transition_probability_evaluator for particles.  Each state's entries are
+ * evaluated the first time they are needed after the parameters change, so
+ * only states that particles visit are evaluated, and objects for different
+ * parameters can be used concurrently from different threads.
+*/
+template<typename DirectionalPersistence>
+class LazyTransitionTable {
+
+    private:
+
+        std::vector<std::size_t> offsets;
+        std::vector<double> rates;
+        std::vector<double> probabilities_table;
+
+        // generation in which each state's entries were last evaluated
+        std::vector<std::uint32_t> evaluated;
+        std::uint32_t generation;
+
+        double directional_persistence;
+        Eigen::VectorXd beta;
+        double delta;
+
+        template<typename State>
+        void evaluate(const State & state) {
+
+            std::size_t i = state.index;
+
+            // Hewitt et. al. (2023) eq. 14
+            rates[i] = delta * std::exp(
+                beta.dot(state.properties.location->x)
+            );
+
+            // Hewitt et. al. (2023) eq. 15
+            double * p = probabilities_table.data() + offsets[i];
+            double total = 0;
+            for(auto destination : state.to) {
+                *p = std::exp(
+                    directional_persistence *
+                    DirectionalPersistence::directional_persistence_covariate(
+                        state.properties.last_movement_direction,
+                        destination->properties.last_movement_direction
+                    )
+                );
+                total += *(p++);
+            }
+            p = probabilities_table.data() + offsets[i];
+            for(std::size_t j = 0; j < state.to.size(); ++j) {
+                p[j] /= total;
+            }
+
+            evaluated[i] = generation;
+        }
+
+    public:
+
+        template<typename Statespace>
+        explicit LazyTransitionTable(const Statespace & statespace) :
+            offsets(transition_offsets(statespace)),
+            rates(statespace.states.size()),
+            probabilities_table(offsets.back()),
+            evaluated(statespace.states.size(), 0), generation(0),
+            directional_persistence(0), delta(1) { }
+
+        /**
+         * Update model parameters, which marks all table entries as stale
+        */
+        void set_parameters(
+            double persistence, const Eigen::Ref<const Eigen::VectorXd> & b,
+            double uniformization
+        ) {
+            directional_persistence = persistence;
+            beta = b;
+            delta = uniformization;
+            if(++generation == 0) {
+                // generation counter wrapped around
+                std::fill(evaluated.begin(), evaluated.end(), 0);
+                generation = 1;
+            }
+        }
+
+        template<typename State>
+        double transition_rate(const State & state) {
+            if(evaluated[state.index] != generation) {
+                evaluate(state);
+            }
+            return rates[state.index];
+        }
+
+        template<typename State>
+        Eigen::Map<const Eigen::VectorXd> probabilities(const State & state) {
+            if(evaluated[state.index] != generation) {
+                evaluate(state);
+            }
+            return Eigen::Map<const Eigen::VectorXd>(
+                probabilities_table.data() + offsets[state.index],
+                state.to.size()
+            );
+        }
+
+};
+
+#endif
@@ -145,8 +145,9 @@ class state_cache_transition_probability_evaluator {
         ) : m_evaluator(&evaluator) { }
 
         const Eigen::VectorXd & probabilities(State & state) {
-            if(state.to_probabilities.size() == 0) {
+            if(!state.to_probabilities_cached) {
                 state.to_probabilities = m_evaluator->probabilities(state);
+                state.to_probabilities_cached = true;
             }
             return state.to_probabilities;
         }
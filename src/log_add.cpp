@@ -2,14 +2,23 @@
 
 #include <Rcpp.h>
 
+/**
+ * Stable evaluation of log(sum(exp(x))) that shifts by the largest term, so 
+ * that sums over zero weights (i.e., -Inf) are -Inf rather than NaN.  The 
+ * evaluation does not use R's API, so it may be called from threads other 
+ * than R's main thread
+*/
 // [[Rcpp::export]]
 double log_sum(const std::vector<double> & x) {
     auto iter = x.begin();
     auto end = x.end();
-    double  res = *(iter++);
-    for(iter; iter != end; ++iter)
-        res = R::logspace_add(res, *iter);
-    return res;
+    double max = *std::max_element(iter, end);
+    if(std::isinf(max)) 
+        return max;
+    double res = 0;
+    for(; iter != end; ++iter)
+        res += std::exp(*iter - max);
+    return max + std::log(res);
 }
 
 // [[Rcpp::export]]
@@ -8,3 +8,11 @@
 */ 
 #include "Domain.h"
 #include "DomainSearch.h"
+#include "Reachability.h"
+#include "FilterSession.h"
+#include "ParticleTuning.h"
+#include "FixedLagSmoothing.h"
+#include "FilterCheckpoint.h"
+#include "TrajectoryFile.h"
+#include "CovariateStack.h"
+#include "DirectionalBias.h"